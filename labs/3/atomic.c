@@ -0,0 +1,26 @@
+#include "defines.h"
+#include "atomic.h"
+
+#ifdef NATIVE
+
+// The store is the last instruction in [AtomicCasBegin, AtomicCasEnd), 
+// so restarting from the top before it has happened is always safe.
+asm (".global	AtomicCas\n"
+     ".global	AtomicCasBegin\n"
+     ".global	AtomicCasEnd\n"
+     "AtomicCas:\n"
+     "AtomicCasBegin:\n"
+     "	ldw	r2,  0(r4)\n"
+     "	bne	r2,  r5, AtomicCasEnd\n"
+     "	stw	r6,  0(r4)\n"
+     "AtomicCasEnd:\n"
+     "	ret\n");
+
+#else /* NATIVE */
+
+uval32 AtomicCas(volatile uval32 *p, uval32 old, uval32 new)
+{
+  return __sync_val_compare_and_swap(p, old, new);
+}
+
+#endif /* NATIVE */
@@ -0,0 +1,13 @@
+#ifndef _ATOMIC_H_
+#define _ATOMIC_H_
+
+#include "defines.h"
+
+// Compare and swap for threads: stores new in *p if it holds old, and 
+// returns what *p held. The Nios II has no atomic instructions, so on 
+// the board this is a restartable sequence: a thread switched out in the
+// middle of it is resumed at its start (see the_isr), which is enough on
+// one processor.
+uval32 AtomicCas(volatile uval32 *p, uval32 old, uval32 new);
+
+#endif
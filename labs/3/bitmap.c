@@ -0,0 +1,164 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "klog.h"
+#include "sched.h"
+
+#include <assert.h>
+
+// Ready queue as one FIFO per priority and a bitmap of the non-empty 
+// ones, so enqueue and dequeue take constant time however many threads 
+// are ready. A summary word says which bitmap words are non-empty.
+#define NUM_PRIORITIES (MIN_PRIORITY + 1)
+#define MAP_WORDS ((NUM_PRIORITIES + 31) / 32)
+
+static TD *Head[NUM_PRIORITIES];
+static TD *Tail[NUM_PRIORITIES];
+static uval32 Map[MAP_WORDS];
+static uval32 Summary;
+
+static void Mark(uval32 priority)
+{
+  Map[priority >> 5] |= 1u << (priority & 31);
+  Summary |= 1u << (priority >> 5);
+}
+
+static void Unmark(uval32 priority)
+{
+  Map[priority >> 5] &= ~(1u << (priority & 31));
+  if (!Map[priority >> 5]) {
+    Summary &= ~(1u << (priority >> 5));
+  }
+}
+
+// Most urgent non-empty priority, or -1.
+static int First(void)
+{
+  int word;
+
+  if (!Summary) {
+    return -1;
+  }
+  word = __builtin_ctz(Summary);
+  return (word << 5) + __builtin_ctz(Map[word]);
+}
+
+static void BitmapInit(void)
+{
+  int i;
+
+  for (i = 0; i < NUM_PRIORITIES; i++) {
+    Head[i] = Tail[i] = NULL;
+  }
+  for (i = 0; i < MAP_WORDS; i++) {
+    Map[i] = 0;
+  }
+  Summary = 0;
+}
+
+static void BitmapEnqueue(TD *td)
+{
+  uval32 p = td->priority;
+
+  // Priorities past MIN_PRIORITY would index past Tail and Map, so every
+  // way of setting one must range check it.
+  assert(p < NUM_PRIORITIES);
+  td->inlist = ReadyQ;
+  td->link = NULL;
+  if (Tail[p]) {
+    Tail[p]->link = td;
+  } else {
+    Head[p] = td;
+    Mark(p);
+  }
+  Tail[p] = td;
+}
+
+static TD *BitmapPeek(void)
+{
+  int p = First();
+
+  return p < 0 ? NULL : Head[p];
+}
+
+static TD *BitmapDequeue(void)
+{
+  int p = First();
+  TD *td;
+
+  if (p < 0) {
+    return NULL;
+  }
+  td = Head[p];
+  Head[p] = td->link;
+  if (!Head[p]) {
+    Tail[p] = NULL;
+    Unmark(p);
+  }
+  return td;
+}
+
+// Linear in the threads of td's priority only.
+static void BitmapRemove(TD *td)
+{
+  uval32 p = td->priority;
+  TD *prev = NULL;
+  TD *cur;
+
+  for (cur = Head[p]; cur && cur != td; cur = cur->link) {
+    prev = cur;
+  }
+  if (!cur) {
+    KLOG_ERROR(KLOG_DEQUEUE_ERROR, td->tid, td->priority, 0);
+    return;
+  }
+
+  if (prev) {
+    prev->link = td->link;
+  } else {
+    Head[p] = td->link;
+  }
+  if (Tail[p] == td) {
+    Tail[p] = prev;
+  }
+  if (!Head[p]) {
+    Unmark(p);
+  }
+}
+
+static void BitmapRequeue(TD *td, uval32 priority)
+{
+  BitmapRemove(td);
+  td->priority = priority;
+  BitmapEnqueue(td);
+}
+
+// Each thread only touches the queue of its own priority, so a batch is
+// no cheaper than its threads one at a time.
+static void BitmapEnqueueBatch(TD **tds, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    BitmapEnqueue(tds[i]);
+  }
+}
+
+static void BitmapRemoveBatch(TD **tds, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    BitmapRemove(tds[i]);
+  }
+}
+
+static void BitmapTick(void)
+{
+}
+
+SchedPolicy BitmapPolicy = {
+  "bitmap", BitmapInit, BitmapEnqueue, BitmapDequeue, BitmapPeek, 
+  BitmapRequeue, BitmapRemove, BitmapEnqueueBatch, BitmapRemoveBatch, 
+  BitmapTick
+};
@@ -0,0 +1,69 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "button.h"
+#include "io.h"
+#include "waitq.h"
+
+#include <stdlib.h>
+
+// Events that arrived while nobody was waiting, oldest at EventHead. 
+// Threads waiting for an event wait on Events.
+static uval32 Events[BUTTON_QUEUE_SIZE];
+static int EventHead;
+static int EventCount;
+
+void InitButtons(void)
+{
+  EventHead = 0;
+  EventCount = 0;
+
+  // Clear out any changes so far and interrupt on the next press.
+  PB_EDGECAPTURE = 0;
+  PB_INTERRUPTMASK = BUTTON_MASK;
+  RequestIrq(PUSHBUTTON_IRQ, PUSHBUTTON_IRQ_PRIORITY, ButtonIsr);
+}
+
+// Called from interrupt_handler(). Hands the pressed buttons straight to 
+// the highest priority waiter, or queues them if there is none. Events 
+// are dropped when the queue is full. The timer may interrupt us, so the
+// wait and ready lists are only touched with interrupts off.
+void ButtonIsr(uvalptr pc)
+{
+  uval32 pressed;
+  bool enabled;
+  TD *td;
+
+  pressed = PB_EDGECAPTURE & BUTTON_MASK;
+  PB_EDGECAPTURE = 0;
+
+  if (!pressed) {
+    return;
+  }
+
+  enabled = IrqLock();
+  if ((td = WaitqDequeue(Events)) != NULL) {
+    *(uval32 *) td->cold->waitdata = pressed;
+    td->cold->waitdata = NULL;
+    WakeThread(td);
+  } else if (EventCount < BUTTON_QUEUE_SIZE) {
+    Events[(EventHead + EventCount) % BUTTON_QUEUE_SIZE] = pressed;
+    EventCount++;
+  }
+  IrqUnlock(enabled);
+}
+
+// Stores the oldest pushbutton event in *event, blocking the invoking 
+// thread until one arrives if none is queued.
+T_RC ButtonWait(uval32 *event)
+{
+  if (EventCount > 0) {
+    *event = Events[EventHead];
+    EventHead = (EventHead + 1) % BUTTON_QUEUE_SIZE;
+    EventCount--;
+    return OK;
+  }
+
+  Active->cold->waitdata = event;
+  return WaitOn(Events);
+}
@@ -0,0 +1,17 @@
+#ifndef _BUTTON_H_
+#define _BUTTON_H_
+
+#include "defines.h"
+#include "list.h"
+
+// KEY1-KEY3; KEY0 is wired to reset.
+#define BUTTON_MASK 0xE
+
+// Number of pushbutton events kept while no thread is waiting for them.
+#define BUTTON_QUEUE_SIZE 16
+
+void InitButtons(void);
+void ButtonIsr(uvalptr pc);
+T_RC ButtonWait(uval32 *event);
+
+#endif
@@ -0,0 +1,74 @@
+#include "defines.h"
+#include "clock.h"
+#include "edf.h"
+#include "fair.h"
+#include "io.h"
+#include "prof.h"
+#include "kinfo.h"
+#include "sched.h"
+#include "timer.h"
+
+#ifndef NATIVE
+#include <time.h>
+#endif /* NATIVE */
+
+volatile uval32 Ticks;
+
+// Starts the interval timer interrupting TICKS_PER_SECOND times a second.
+void InitClock(void)
+{
+  uval32 period = CLOCK_HZ / TICKS_PER_SECOND;
+
+  Ticks = 0;
+
+  TIMER_PERIODL = period & 0xFFFF;
+  TIMER_PERIODH = period >> 16;
+  TIMER_STATUS = 0;
+  TIMER_CONTROL = TIMER_START | TIMER_CONT | TIMER_ITO;
+  RequestIrq(TIMER_IRQ, TIMER_IRQ_PRIORITY, ClockIsr);
+}
+
+// Called from interrupt_handler() on every timer interrupt, with the pc 
+// the interrupt arrived at. Nothing outranks the timer, but it keeps 
+// interrupts off while it changes the ready lists in case that changes.
+void ClockIsr(uvalptr pc)
+{
+  bool enabled;
+
+  if (!(TIMER_STATUS & TIMER_TO)) {
+    return;
+  }
+  // Writing clears the timeout bit.
+  TIMER_STATUS = 0;
+
+  Ticks++;
+  KInfoPage.ticks = Ticks;
+  enabled = IrqLock();
+  EdfTick();
+  FairTick();
+  Sched->tick();
+  TimerTick();
+  IrqUnlock(enabled);
+  ProfSample(pc);
+}
+
+// Fine grained time in CLOCK_HZ units, for measurements. Wraps every 
+// 85 seconds.
+uval32 ReadClock(void)
+{
+#ifdef NATIVE
+  uval32 period = CLOCK_HZ / TICKS_PER_SECOND;
+  uval32 left;
+
+  // Writing a snap register latches the counter, which counts down.
+  TIMER_SNAPL = 0;
+  left = (TIMER_SNAPH << 16) | (TIMER_SNAPL & 0xFFFF);
+  return Ticks * period + (period - 1 - left);
+#else /* NATIVE */
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uval32) ((unsigned long long) now.tv_sec * CLOCK_HZ +
+		   now.tv_nsec / (1000000000 / CLOCK_HZ));
+#endif /* NATIVE */
+}
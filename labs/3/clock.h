@@ -0,0 +1,17 @@
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+#include "defines.h"
+
+// The interval timer counts at the 50 MHz system clock.
+#define CLOCK_HZ 50000000
+#define TICKS_PER_SECOND 100
+
+// Timer interrupts since InitClock().
+extern volatile uval32 Ticks;
+
+void InitClock(void);
+void ClockIsr(uvalptr pc);
+uval32 ReadClock(void);
+
+#endif
@@ -0,0 +1,345 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "main.h"
+#include "io.h"
+#include "cluster.h"
+#include "waitq.h"
+
+uval32 ClusterNode;
+
+// Messages waiting for their thread, in a list per tid through next[]. 
+// Threads blocked in SYS_MSG_RECV wait on their MailHead entry.
+static ClusterMsg Inbox[CLUSTER_INBOX];
+static int InboxNext[CLUSTER_INBOX];
+static int InboxFree;
+static int MailHead[NUM_TID + 1];
+static int MailTail[NUM_TID + 1];
+// Messages for threads that do not exist.
+static uval32 Dropped;
+// Set while messages wait in the rings for room in the inbox.
+static bool Backlog;
+// Makes the next Drain() look again at every message waiting behind one
+// that did not fit.
+static bool Rescan;
+
+static void Drain(void);
+
+void InitCluster(void)
+{
+  int i;
+
+  ClusterNode = 0;
+  for (i = 0; i < CLUSTER_INBOX; i++) {
+    InboxNext[i] = i + 1;
+  }
+  InboxNext[CLUSTER_INBOX - 1] = -1;
+  InboxFree = 0;
+  for (i = 0; i <= NUM_TID; i++) {
+    MailHead[i] = MailTail[i] = -1;
+  }
+  Dropped = 0;
+  Backlog = FALSE;
+  Rescan = FALSE;
+}
+
+// Hands msg to its thread if it is waiting for one, or, if inbox is set,
+// keeps it in the inbox. Returns FALSE, leaving msg alone, if it can go 
+// neither way.
+static bool Deliver(ClusterMsg *msg, bool inbox)
+{
+  ThreadId tid = msg->dstTid;
+  TD *td;
+  int i;
+
+  if (!tidInUse(tid)) {
+    Dropped++;
+    return TRUE;
+  }
+
+  if ((td = WaitqDequeue(&MailHead[tid])) != NULL) {
+    *(ClusterMsg *) td->cold->waitdata = *msg;
+    td->cold->waitdata = NULL;
+    WakeThread(td);
+    return TRUE;
+  } else if (!inbox || InboxFree < 0) {
+    return FALSE;
+  }
+
+  i = InboxFree;
+  InboxFree = InboxNext[i];
+  Inbox[i] = *msg;
+  InboxNext[i] = -1;
+  if (MailTail[tid] >= 0) {
+    InboxNext[MailTail[tid]] = i;
+  } else {
+    MailHead[tid] = i;
+  }
+  MailTail[tid] = i;
+  return TRUE;
+}
+
+#ifndef NATIVE
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#define CACHE_LINE 64
+
+typedef struct type_CLUSTER_RING ClusterRing;
+typedef struct type_CLUSTER_SHARED ClusterShared;
+
+// Single producer, single consumer. Each side only writes its own index,
+// and publishes it with a release store after the slots it covers, so 
+// neither needs a lock. The indices run freely and wrap.
+struct type_CLUSTER_RING
+{
+  // Next slot the sender fills.
+  uval32 head;
+  uval8 pad0[CACHE_LINE - sizeof(uval32)];
+  // Next slot the receiver takes.
+  uval32 tail;
+  uval8 pad1[CACHE_LINE - sizeof(uval32)];
+  ClusterMsg slots[CLUSTER_RING_SIZE];
+};
+
+struct type_CLUSTER_SHARED
+{
+  uval32 nodes;
+  // Set by senders, cleared by the node when it takes CLUSTER_IRQ.
+  uval32 doorbell[CLUSTER_MAX_NODES];
+  // Indexed [from][to].
+  ClusterRing rings[CLUSTER_MAX_NODES][CLUSTER_MAX_NODES];
+};
+
+static ClusterShared *Shared;
+
+static bool RingPut(ClusterRing *r, ClusterMsg *msg)
+{
+  uval32 head = r->head;
+
+  if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) == CLUSTER_RING_SIZE) {
+    return FALSE;
+  }
+  r->slots[head & (CLUSTER_RING_SIZE - 1)] = *msg;
+  __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+  return TRUE;
+}
+
+// Marks a ring slot whose message was delivered ahead of its turn. No 
+// message in a ring is addressed to it, since it is not a node.
+#define CLUSTER_TAKEN CLUSTER_MAX_NODES
+
+// Where the last look past a stuck message stopped, per ring into this 
+// node.
+static uval32 Scanned[CLUSTER_MAX_NODES];
+
+// Delivers what has arrived from every node. What does not fit in the 
+// inbox stays in its ring, holding back its senders, but not the 
+// messages behind it: those for threads blocked in SYS_MSG_RECV are 
+// handed over at once and their slots marked taken. A message is only 
+// passed over while its thread is not waiting, and MsgRecv() rescans 
+// when one starts to, so each thread still gets a sender's messages in 
+// order. Otherwise only new arrivals are looked at, so that a long 
+// backlog is not walked again for every message.
+static void Drain(void)
+{
+  ClusterRing *r;
+  ClusterMsg *msg;
+  uval32 from, head, i;
+
+  if (!Shared) {
+    return;
+  }
+
+  Backlog = FALSE;
+  for (from = 0; from < Shared->nodes; from++) {
+    r = &Shared->rings[from][ClusterNode];
+    head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    while (r->tail != head) {
+      msg = &r->slots[r->tail & (CLUSTER_RING_SIZE - 1)];
+      if (msg->dstNode != CLUSTER_TAKEN && !Deliver(msg, TRUE)) {
+	break;
+      }
+      __atomic_store_n(&r->tail, r->tail + 1, __ATOMIC_RELEASE);
+    }
+    if (r->tail == head) {
+      continue;
+    }
+
+    Backlog = TRUE;
+    i = r->tail + 1;
+    if (!Rescan && (int) (Scanned[from] - i) > 0) {
+      i = Scanned[from];
+    }
+    for (; i != head; i++) {
+      msg = &r->slots[i & (CLUSTER_RING_SIZE - 1)];
+      if (msg->dstNode != CLUSTER_TAKEN && Deliver(msg, FALSE)) {
+	msg->dstNode = CLUSTER_TAKEN;
+      }
+    }
+    Scanned[from] = head;
+  }
+  Rescan = FALSE;
+}
+
+static void ClusterIsr(uvalptr pc)
+{
+  bool enabled = IrqLock();
+
+  Drain();
+  IrqUnlock(enabled);
+}
+
+// The doorbell is this node's interrupt line: a raised doorbell is taken
+// as CLUSTER_IRQ, as a device interrupt would be. Called by the host 
+// drivers between steps of their threads.
+void ClusterPoll(void)
+{
+  bool enabled;
+
+  if (!Shared || !__atomic_exchange_n(&Shared->doorbell[ClusterNode], 0, 
+				      __ATOMIC_ACQUIRE)) {
+    return;
+  }
+
+  RaiseIrq(CLUSTER_IRQ);
+  enabled = IrqLock();
+  interrupt_handler(0);
+  IrqUnlock(enabled);
+  if (NeedResched) {
+    Preempt();
+  }
+}
+
+uval32 ClusterDropped(void)
+{
+  return Dropped;
+}
+
+// Runs run() on each of `nodes` copies of this kernel, each in a process
+// of its own, and waits for them all. Every copy starts from the state 
+// the kernel is in now, so threads created the same way get the same 
+// tids on every node.
+int ClusterStart(uval32 nodes, void (*run)(void))
+{
+  pid_t pids[CLUSTER_MAX_NODES];
+  uval32 i;
+
+  if (nodes < 1 || nodes > CLUSTER_MAX_NODES) {
+    return 1;
+  }
+
+  Shared = mmap(NULL, sizeof(ClusterShared), PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (Shared == MAP_FAILED) {
+    perror("mmap");
+    Shared = NULL;
+    return 1;
+  }
+  Shared->nodes = nodes;
+
+  for (i = 0; i < nodes; i++) {
+    if ((pids[i] = fork()) == 0) {
+      ClusterNode = i;
+      RequestIrq(CLUSTER_IRQ, CLUSTER_IRQ_PRIORITY, ClusterIsr);
+      run();
+      _exit(0);
+    }
+  }
+  for (i = 0; i < nodes; i++) {
+    waitpid(pids[i], NULL, 0);
+  }
+
+  munmap(Shared, sizeof(ClusterShared));
+  Shared = NULL;
+  return 0;
+}
+
+#else /* NATIVE */
+
+static void Drain(void)
+{
+}
+
+#endif /* NATIVE */
+
+// SYS_MSG_SEND: sends msg to thread msg->dstTid of node msg->dstNode and
+// stores in *sent, if given, whether it went. It does not if the ring to
+// that node is full, or the node does not exist.
+T_RC MsgSend(ClusterMsg *msg, bool *sent)
+{
+  bool ok = FALSE;
+
+  msg->srcNode = ClusterNode;
+  msg->srcTid = Active->tid;
+
+  if (msg->dstNode == ClusterNode) {
+    ok = Deliver(msg, TRUE);
+#ifndef NATIVE
+  } else if (Shared && msg->dstNode < Shared->nodes) {
+    ok = RingPut(&Shared->rings[ClusterNode][msg->dstNode], msg);
+    if (ok) {
+      __atomic_store_n(&Shared->doorbell[msg->dstNode], 1, __ATOMIC_RELEASE);
+    }
+#endif /* NATIVE */
+  }
+
+  if (sent) {
+    *sent = ok;
+  }
+  return ok ? OK : RESOURCE_ERROR;
+}
+
+// SYS_MSG_RECV: takes the oldest message for the Active thread into *msg,
+// blocking until there is one.
+T_RC MsgRecv(ClusterMsg *msg)
+{
+  ThreadId tid = Active->tid;
+  T_RC rc;
+  int i;
+
+  if (Backlog) {
+    Drain();
+  }
+
+  if ((i = MailHead[tid]) >= 0) {
+    *msg = Inbox[i];
+    MailHead[tid] = InboxNext[i];
+    if (MailHead[tid] < 0) {
+      MailTail[tid] = -1;
+    }
+    InboxNext[i] = InboxFree;
+    InboxFree = i;
+    // The slot just freed may let in a message that did not fit.
+    if (Backlog) {
+      Drain();
+    }
+    return OK;
+  }
+
+  Active->cold->waitdata = msg;
+  rc = WaitOn(&MailHead[tid]);
+  // One may be in a ring behind a message the inbox had no room for, 
+  // which Drain() hands straight to us now that we wait.
+  if (Backlog) {
+    Rescan = TRUE;
+    Drain();
+  }
+  return rc;
+}
+
+// Throws away the messages left for td, which is being destroyed.
+void ClusterExit(TD *td)
+{
+  int i;
+
+  while ((i = MailHead[td->tid]) >= 0) {
+    MailHead[td->tid] = InboxNext[i];
+    InboxNext[i] = InboxFree;
+    InboxFree = i;
+  }
+  MailTail[td->tid] = -1;
+}
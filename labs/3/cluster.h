@@ -0,0 +1,52 @@
+#ifndef _CLUSTER_H_
+#define _CLUSTER_H_
+
+#include "defines.h"
+#include "list.h"
+
+// Messages between threads, addressed by (node, tid). A kernel instance
+// is a node; on the board there is only node 0. On x86, ClusterStart() 
+// runs several nodes as processes, joined by a lock-free ring for each 
+// ordered pair of nodes in shared memory. A sender rings the doorbell of
+// the receiving node, which takes it as CLUSTER_IRQ and hands the 
+// messages to their threads, waking any blocked in SYS_MSG_RECV.
+#define CLUSTER_MAX_NODES 8
+// Slots per ring, a power of two.
+#define CLUSTER_RING_SIZE 256
+#define CLUSTER_MSG_WORDS 4
+// Messages that arrived before their thread asked for them, per node.
+#define CLUSTER_INBOX 256
+
+#define CLUSTER_IRQ          3
+#define CLUSTER_IRQ_PRIORITY 3
+
+typedef struct type_CLUSTER_MSG ClusterMsg;
+
+struct type_CLUSTER_MSG
+{
+  // Set by the sender.
+  uval32 dstNode;
+  ThreadId dstTid;
+  // Set by the kernel.
+  uval32 srcNode;
+  ThreadId srcTid;
+  uval32 data[CLUSTER_MSG_WORDS];
+};
+
+// This kernel's node.
+extern uval32 ClusterNode;
+
+void InitCluster(void);
+T_RC MsgSend(ClusterMsg *msg, bool *sent);
+T_RC MsgRecv(ClusterMsg *msg);
+void ClusterExit(TD *td);
+
+#ifndef NATIVE
+#include <sys/types.h>
+
+int ClusterStart(uval32 nodes, void (*run)(void));
+void ClusterPoll(void);
+uval32 ClusterDropped(void);
+#endif /* NATIVE */
+
+#endif
@@ -0,0 +1,224 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "user.h"
+#include "clock.h"
+#include "cluster.h"
+#include "clusterbench.h"
+
+#ifndef NATIVE
+
+#include <stdio.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+typedef struct type_CLUSTERBENCH_RESULTS ClusterBenchResults;
+
+// Written by node 0 only, read by the parent once the nodes are done. 
+// Times are in ReadClock() units, which all processes share.
+struct type_CLUSTERBENCH_RESULTS
+{
+  uval32 pings;
+  unsigned long long rttTotal;
+  uval32 rttMax;
+  uval32 received;
+  uval32 first;
+  uval32 last;
+  unsigned long long latTotal;
+  uval32 latMax;
+  uval32 dropped;
+};
+
+typedef enum { CB_SEND, CB_RECV, CB_GOT } ClusterBenchPhase;
+
+static ClusterBenchResults *Results;
+static uval32 Nodes;
+// The bench thread's tid, the same on every node.
+static ThreadId Peer;
+
+// Per node, since every node is a process of its own.
+static ClusterBenchPhase Phase;
+static uval32 Count;
+static ClusterMsg In, Out;
+
+// The bench thread's body, played by Drive() on x86.
+static void ClusterBenchThread(void)
+{
+}
+
+static bool Send(uval32 node)
+{
+  bool sent;
+
+  Out.dstNode = node;
+  Out.dstTid = Peer;
+  Out.data[0] = ReadClock();
+  SysCall(SYS_MSG_SEND, (uvalptr) &Out, (uvalptr) &sent, 0);
+  return sent;
+}
+
+// Node 0 sends a ping and waits for it to come back; node 1 returns each
+// ping it gets.
+static bool PingStep(void)
+{
+  uval32 rtt;
+
+  switch (Phase) {
+  case CB_SEND:
+    if (Send(ClusterNode ^ 1)) {
+      Phase = CB_RECV;
+    }
+    break;
+  case CB_RECV:
+    // Blocks; the reply is in In when the thread is next Active.
+    Phase = CB_GOT;
+    SysCall(SYS_MSG_RECV, (uvalptr) &In, 0, 0);
+    break;
+  case CB_GOT:
+    if (ClusterNode == 0) {
+      rtt = ReadClock() - In.data[0];
+      Results->rttTotal += rtt;
+      if (rtt > Results->rttMax) {
+	Results->rttMax = rtt;
+      }
+      Results->pings++;
+      Phase = CB_SEND;
+    } else {
+      Out.dstNode = In.srcNode;
+      Out.dstTid = In.srcTid;
+      Out.data[0] = In.data[0];
+      SysCall(SYS_MSG_SEND, (uvalptr) &Out, 0, 0);
+      Phase = CB_RECV;
+    }
+    return ++Count < CLUSTERBENCH_PINGS;
+  }
+  return TRUE;
+}
+
+// Every node but 0 sends to node 0 as fast as the ring lets it.
+static bool FanStep(void)
+{
+  uval32 lat, now;
+
+  if (ClusterNode != 0) {
+    if (Send(0)) {
+      Count++;
+    } else {
+      // The ring is full; let node 0 catch up.
+      sched_yield();
+    }
+    return Count < CLUSTERBENCH_MSGS;
+  }
+
+  switch (Phase) {
+  case CB_SEND:
+  case CB_RECV:
+    Phase = CB_GOT;
+    SysCall(SYS_MSG_RECV, (uvalptr) &In, 0, 0);
+    break;
+  case CB_GOT:
+    now = ReadClock();
+    lat = now - In.data[0];
+    if (Results->received++ == 0) {
+      Results->first = now;
+    }
+    Results->last = now;
+    Results->latTotal += lat;
+    if (lat > Results->latMax) {
+      Results->latMax = lat;
+    }
+    Phase = CB_RECV;
+    return Results->received < (Nodes - 1) * CLUSTERBENCH_MSGS;
+  }
+  return TRUE;
+}
+
+// Threads never run on x86, so the bench thread takes its steps here 
+// whenever it is Active, as in WorkloadRun(). A node with nothing to run
+// gives the host processor to the others while it waits for a message.
+static void Drive(bool (*step)(void))
+{
+  Phase = CB_SEND;
+  Count = 0;
+
+  while (1) {
+    ClusterPoll();
+    if (Active->cold->regs.pc == (uval32) (uvalptr) ClusterBenchThread) {
+      if (!step()) {
+	break;
+      }
+    } else if (Active->tid == IDLE_TID) {
+      sched_yield();
+    } else {
+      SysCall(SYS_SUSP, 0, 0, 0);
+    }
+  }
+  if (ClusterNode == 0) {
+    Results->dropped = ClusterDropped();
+  }
+}
+
+static void PingRun(void)
+{
+  Drive(PingStep);
+}
+
+static void FanRun(void)
+{
+  Drive(FanStep);
+}
+
+static double Us(double clocks)
+{
+  return 1e6 * clocks / CLOCK_HZ;
+}
+
+int ClusterBench(uval32 nodes)
+{
+  int i;
+
+  if (nodes < 2 || nodes > CLUSTER_MAX_NODES) {
+    printf("%s needs 2 to %d nodes\n", CLUSTERBENCH_ENV, CLUSTER_MAX_NODES);
+    return 1;
+  }
+  Nodes = nodes;
+
+  Results = mmap(NULL, sizeof(ClusterBenchResults), PROT_READ | PROT_WRITE,
+		 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (Results == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+
+  SysCall(SYS_CREATE, (uvalptr) ClusterBenchThread, STACKSIZE, 
+	  CLUSTERBENCH_PRIORITY);
+  for (i = IDLE_TID + 1; i <= NUM_TID; i++) {
+    if (tidInUse(i) && 
+	TD_TABLE[i].cold->regs.pc == (uval32) (uvalptr) ClusterBenchThread) {
+      Peer = i;
+    }
+  }
+
+  if (ClusterStart(2, PingRun) != 0) {
+    return 1;
+  }
+  printf("ping-pong, node 0 and 1: %u round trips, mean %.1f us, max %.1f us\n",
+	 Results->pings, Us((double) Results->rttTotal / Results->pings),
+	 Us(Results->rttMax));
+
+  if (ClusterStart(nodes, FanRun) != 0) {
+    return 1;
+  }
+  printf("fan-in, %u nodes to node 0: %u messages, %.0f messages/s\n",
+	 nodes - 1, Results->received,
+	 (double) (Results->received - 1) * CLOCK_HZ / 
+	 (Results->last - Results->first ? Results->last - Results->first : 1));
+  printf("  one-way latency mean %.1f us, max %.1f us, %u dropped\n",
+	 Us((double) Results->latTotal / Results->received),
+	 Us(Results->latMax), Results->dropped);
+
+  munmap(Results, sizeof(ClusterBenchResults));
+  return 0;
+}
+
+#endif /* NATIVE */
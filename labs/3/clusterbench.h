@@ -0,0 +1,21 @@
+#ifndef _CLUSTERBENCH_H_
+#define _CLUSTERBENCH_H_
+
+#include "defines.h"
+
+// Cross-node messaging benchmark, x86 build only. With KCLUSTER=<nodes> 
+// in the environment prog runs a cluster of <nodes> kernels. Node 0 
+// first plays CLUSTERBENCH_PINGS round trips with node 1, then takes 
+// CLUSTERBENCH_MSGS messages from each of the other nodes at once. It 
+// prints the round trip time, and the throughput and one-way latency of
+// the fan-in.
+#define CLUSTERBENCH_ENV "KCLUSTER"
+#define CLUSTERBENCH_PINGS 10000
+#define CLUSTERBENCH_MSGS 100000
+#define CLUSTERBENCH_PRIORITY 10
+
+#ifndef NATIVE
+int ClusterBench(uval32 nodes);
+#endif /* NATIVE */
+
+#endif
@@ -5,16 +5,32 @@
 //#define NATIVE
 
 typedef unsigned char  uval8;
+typedef unsigned short uval16;
 typedef unsigned int   uval32;
+typedef int            sval32;
 typedef uval32 ThreadId; 
-
-typedef enum { SYS_CREATE, SYS_DIST, SYS_YIELD, SYS_SUSP, SYS_RESUME, SYS_CHANGE_PRI} SysCallType;
-typedef enum { SYS_ENTER, SYS_EXIT } SysCallDir; 
+// Wide enough to carry a pointer through a system call argument.
+typedef unsigned long uvalptr;
+
+typedef enum { SYS_CREATE, SYS_DIST, SYS_YIELD, SYS_SUSP, SYS_RESUME, SYS_CHANGE_PRI, \
+  SYS_BUTTON_WAIT, SYS_LCD_POST, SYS_LCD_WAIT, SYS_CREATE_EDF, SYS_EDF_NEXT, \
+  SYS_CREATE_FAIR, SYS_POOL_CREATE, SYS_POOL_SUBMIT, SYS_POOL_WAIT, \
+  SYS_LTASK_CREATE, SYS_LTASK_SIGNAL, SYS_LTASK_NEXT, SYS_WAIT, SYS_WAKE, \
+  SYS_LAT_DUMP, SYS_PROF, SYS_KINFO, SYS_BARRIER_CREATE, SYS_BARRIER_WAIT, \
+  SYS_BARRIER_DESTROY, SYS_LATCH_CREATE, SYS_LATCH_COUNT_DOWN, \
+  SYS_LATCH_WAIT, SYS_LATCH_DESTROY, SYS_RW_READ, SYS_RW_WRITE, \
+  SYS_RW_UNLOCK, SYS_TIMER_CREATE, SYS_TIMER_CANCEL, SYS_TIMER_WAIT, \
+  SYS_TIMER_NEXT, SYS_SEM_CREATE, SYS_SEM_POST, SYS_SEM_WAIT, SYS_SEM_DESTROY, \
+  SYS_WAIT_ANY, SYS_HEAP_ALLOC, SYS_HEAP_FREE, SYS_HEAP_STATS, \
+  SYS_KLOG_DUMP, SYS_MSG_SEND, SYS_MSG_RECV, SYS_GROUP_CREATE, \
+  SYS_CREATE_GROUPED, SYS_GROUP_CTL} SysCallType;
 
 typedef enum { RC_SUCCESS, RC_FAILED } RC;
 
-typedef enum { RESOURCE_ERROR, STACK_ERROR, PRIORITY_ERROR, TID_ERROR, \
-  NOT_BLOCKED, FAILED, OK} T_RC;
+// OK is 0 and the errors are negative, so a system call result above OK
+// can carry a value, such as the tid SYS_CREATE returns.
+typedef enum { RESOURCE_ERROR = -7, STACK_ERROR, PRIORITY_ERROR, TID_ERROR, \
+  NOT_BLOCKED, FAILED, ADMISSION_ERROR, OK} T_RC;
 
 typedef int bool;
 #define TRUE (bool)1
@@ -26,8 +42,9 @@ typedef int bool;
 
 //User-mode, Interrupts Enabled
 #define DEFAULT_THREAD_SR 0x0003
-//Interrupts Enabled
-#define DEFAULT_KERNEL_SR 0x0001
+//Interrupts Disabled: an interrupt that arrives during a system call is 
+//taken on the way back to the thread, where the_isr can reschedule.
+#define DEFAULT_KERNEL_SR 0x0000
 
 #define MAX_THREADS 5
 
@@ -37,45 +54,42 @@ typedef int bool;
 // Ours has two: change from 4 to 8, as noted in p.5 of the handout.
 #define SYS_HANDLER_OFFSET 8
 
+// Size of the register frame the_isr keeps on a thread's stack, and the
+// offsets of the saved r2, which carries a system call's result back, and
+// ea (r29) within it.
+#define FRAME_SIZE 116
+#define FRAME_R2_OFFSET 8
+#define FRAME_EA_OFFSET 108
+
 #ifdef NATIVE
 
 #define JTAG_UART_DATA ((volatile int*) 0x10001000) 
 #define JTAG_UART_CONTROL ((volatile int*) (0x10001000+4)) 
 
 #define MOVE_SP_TO_ACTIVE				\
-  asm volatile("stw r27, %0" : "=m"(Active->regs.sp))
+  asm volatile("stw r27, %0" : "=m"(Active->cold->regs.sp))
 
 #define MOVE_PC_TO_ACTIVE				\
-  asm volatile("stw r29, %0" : "=m" (Active->regs.pc)) 
+  asm volatile("stw r29, %0" : "=m" (Active->cold->regs.pc)) 
 
 #define MOVE_SR_TO_ACTIVE				\
   asm volatile("rdctl r10, ctl1\n\t"				\
-	       "stw r10, %0" : : "m" (Active->regs.sr))
+	       "stw r10, %0" : : "m" (Active->cold->regs.sr))
 
 #define MOVE_ACTIVE_TO_SP				\
-  asm volatile("ldw r27, %0" : : "m"(Active->regs.sp))	
-
-#define MOVE_ACTIVE_TO_PC				\
-  asm volatile("ldw r29, %0" : : "m"(Active->regs.pc)) 
+  asm volatile("ldw r27, %0" : : "m"(Active->cold->regs.sp))	
 
 #define MOVE_ACTIVE_TO_SR					\
   asm volatile("ldw r10, %0\n\t"				\
-	       "wrctl ctl1, r10" : : "m" (Active->regs.sr))
+	       "wrctl ctl1, r10" : : "m" (Active->cold->regs.sr))
 
 #define SET_KERNEL_SP							\
   asm volatile("ldw r27, %0\n\t"					\
-	       "subi r27, r27, %1" : : "m" (Kernel.regs.sp), "i" (SYS_HANDLER_OFFSET))
+	       "subi r27, r27, %1" : : "m" (Kernel.cold->regs.sp), "i" (SYS_HANDLER_OFFSET))
 
 
 #define SET_KERNEL_FP					\
-  asm volatile("ldw r28, %0" : : "m" (Kernel.regs.sp))
-
-#define SET_KERNEL_PC					\
-  asm volatile("ldw r29, %0" : : "m" (Kernel.regs.pc))
-
-#define SET_KERNEL_SR						\
-  asm volatile("ldw r10, %0\n\t"				\
-	       "wrctl ctl1, r10" : : "m" (Kernel.regs.sr))
+  asm volatile("ldw r28, %0" : : "m" (Kernel.cold->regs.sp))
 
 
 //Setting bit 1 to 1 in ctl0 sets processor to user mode
@@ -0,0 +1,150 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "clock.h"
+#include "edf.h"
+
+#include <stdlib.h>
+
+// Contains the TDs of all EDF threads that are ready to run, ordered by
+// absolute deadline.
+LL* EdfQ;
+
+// Contains the TDs of all EDF threads that used up their budget or 
+// finished their job, keyed by the time until their next period starts.
+LL* ThrottleQ;
+
+uval32 EdfUtil;
+
+// Share of the CPU needed by a thread with the given parameters, rounded 
+// up. Uses the deadline when it is shorter than the period, which keeps 
+// the admission test sufficient for constrained deadlines.
+static uval32 Density(uval32 budget, uval32 deadline)
+{
+  return (budget * EDF_UTIL_SCALE + deadline - 1) / deadline;
+}
+
+// Records a deadline miss for td's current job, once.
+static void CheckMiss(TD *td)
+{
+  if (td && td->sched == SCHED_EDF && !td->cold->edf.missed &&
+      Ticks > td->deadline) {
+    td->cold->edf.missed = TRUE;
+    td->cold->edf.misses++;
+  }
+}
+
+// Starts a new job for td at the beginning of its period and makes it 
+// ready to run.
+static void StartJob(TD *td)
+{
+  td->deadline = td->cold->edf.release + td->cold->edf.deadline;
+  td->cold->edf.remaining = td->cold->edf.budget;
+  td->cold->edf.missed = FALSE;
+  WakeThread(td);
+}
+
+// Puts td, which is on no list, to sleep until its next period.
+static void Throttle(TD *td)
+{
+  do {
+    td->cold->edf.release += td->cold->edf.period;
+  } while (td->cold->edf.release <= Ticks);
+
+  WaitlistEnqueue(td, td->cold->edf.release - Ticks, ThrottleQ);
+}
+
+void InitEdf(void)
+{
+  EdfQ = CreateList(L_DEADLINE);
+  ThrottleQ = CreateList(L_WAITING);
+  EdfUtil = 0;
+}
+
+// Creates a thread in the EDF class and returns its tid. Its first 
+// period starts now. Returns ADMISSION_ERROR if the parameters are 
+// inconsistent or if admitting it could make any EDF thread miss its 
+// deadlines.
+sval32 CreateEdfThread(uval32 pc, EdfParams *params)
+{
+  uval32 deadline, density;
+  TD *thread;
+  T_RC rc;
+
+  deadline = params->deadline ? params->deadline : params->period;
+  if (params->budget == 0 || params->budget > deadline ||
+      deadline > params->period) {
+    return ADMISSION_ERROR;
+  }
+
+  density = Density(params->budget, deadline);
+  if (EdfUtil + density > EDF_UTIL_LIMIT) {
+    return ADMISSION_ERROR;
+  }
+
+  if ((rc = AllocThread(pc, EDF_PRIORITY, &thread)) != OK) {
+    return rc;
+  }
+  EdfUtil += density;
+
+  thread->sched = SCHED_EDF;
+  thread->cold->edf.period = params->period;
+  thread->cold->edf.budget = params->budget;
+  thread->cold->edf.deadline = deadline;
+  thread->cold->edf.release = Ticks;
+  StartJob(thread);
+
+  if (RunsBefore(thread, Active)) {
+    Yield();
+  }
+  return thread->tid;
+}
+
+// Called by an EDF thread when its job for this period is done.
+T_RC EdfNextPeriod(void)
+{
+  if (Active->sched != SCHED_EDF) {
+    return FAILED;
+  }
+
+  CheckMiss(Active);
+  Throttle(Active);
+  Dispatch();
+
+  return OK;
+}
+
+// Called on every timer tick. Charges the running EDF job, throttling it 
+// when its budget runs out, and starts the jobs whose period begins.
+void EdfTick(void)
+{
+  TD *td;
+
+  if (Active->sched == SCHED_EDF && Active->cold->edf.remaining > 0) {
+    if (--Active->cold->edf.remaining == 0) {
+      CheckMiss(Active);
+      Throttle(Active);
+      NeedResched = TRUE;
+    }
+  }
+
+  if ((td = ThrottleQ->head) != NULL) {
+    td->waittime--;
+    while ((td = ThrottleQ->head) != NULL && td->waittime <= 0) {
+      DequeueHead(ThrottleQ);
+      StartJob(td);
+    }
+  }
+
+  // Lists are in deadline order, so only the first job can be late.
+  CheckMiss(Active);
+  CheckMiss(EdfQ->head);
+}
+
+// Returns the utilization reserved by td, which is being destroyed.
+void EdfExit(TD *td)
+{
+  if (td->sched == SCHED_EDF) {
+    EdfUtil -= Density(td->cold->edf.budget, td->cold->edf.deadline);
+  }
+}
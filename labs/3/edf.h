@@ -0,0 +1,41 @@
+#ifndef _EDF_H_
+#define _EDF_H_
+
+#include "defines.h"
+#include "list.h"
+
+// Priority given to EDF threads, ahead of every priority class thread.
+#define EDF_PRIORITY 0
+
+// Utilization is kept in fixed point, EDF_UTIL_SCALE being the whole CPU.
+#define EDF_UTIL_SCALE 1024
+// Share of the CPU the EDF class may reserve; the rest is left to the 
+// priority class.
+#define EDF_UTIL_LIMIT (EDF_UTIL_SCALE * 9 / 10)
+
+typedef struct type_EDF_PARAMS EdfParams;
+
+// Passed to SYS_CREATE_EDF. All times are in timer ticks.
+struct type_EDF_PARAMS
+{
+  uval32 period;
+  // CPU time the thread may use in each period.
+  uval32 budget;
+  // Relative to the start of each period; 0 means the end of the period.
+  uval32 deadline;
+};
+
+// EDF threads ready to run, earliest absolute deadline first.
+extern LL* EdfQ;
+// EDF threads waiting for their next period, as a waiting list.
+extern LL* ThrottleQ;
+// Utilization reserved by all admitted EDF threads.
+extern uval32 EdfUtil;
+
+void InitEdf(void);
+sval32 CreateEdfThread(uval32 pc, EdfParams *params);
+T_RC EdfNextPeriod(void);
+void EdfTick(void);
+void EdfExit(TD *td);
+
+#endif
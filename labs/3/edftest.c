@@ -0,0 +1,118 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "clock.h"
+#include "edf.h"
+#include "workload.h"
+#include "edftest.h"
+
+#ifndef NATIVE
+
+#include <stdio.h>
+
+typedef struct type_EDF_SET EdfSet;
+
+struct type_EDF_SET
+{
+  char *name;
+  // Whether the set is expected to pass admission control. The others
+  // are admitted anyway, to see what EDF does with them.
+  bool admit;
+  bool overloaded;
+  int count;
+  EdfParams task[EDFTEST_MAX_TASKS];
+};
+
+static EdfSet Sets[] = {
+  { "U=0.80", TRUE, FALSE, 3, { { 10, 3, 0 }, { 20, 6, 0 }, { 40, 8, 0 } } },
+  { "D<T, density 0.83", TRUE, FALSE, 3, 
+    { { 10, 2, 5 }, { 20, 5, 15 }, { 50, 5, 0 } } },
+  { "U=1.00", FALSE, FALSE, 3, { { 10, 5, 0 }, { 20, 6, 0 }, { 25, 5, 0 } } },
+  { "U=1.20", FALSE, TRUE, 2, { { 10, 6, 0 }, { 20, 12, 0 } } },
+};
+
+// Runs set for ticks and returns the number of deadline misses, or -1 if 
+// admission control did not do what was expected.
+static int Run(EdfSet *set, uval32 ticks)
+{
+  ThreadId tids[EDFTEST_MAX_TASKS];
+  int i, n, misses = 0;
+  sval32 tid;
+
+  for (n = 0; n < set->count; n++) {
+    // Skips admission control for the sets that would fail it.
+    if (!set->admit) {
+      EdfUtil = 0;
+    }
+    if ((tid = CreateEdfThread((uval32) (uvalptr) WorkloadNop, &set->task[n])) < OK) {
+      printf("%s: task %d not admitted\n", set->name, n);
+      misses = -1;
+      break;
+    }
+    tids[n] = tid;
+  }
+
+  for (i = 0; i < ticks && misses == 0; i++) {
+    WorkloadTick();
+  }
+
+  for (i = 0; i < n; i++) {
+    if (misses >= 0) {
+      misses += getTD(tids[i])->cold->edf.misses;
+    }
+    DestroyThread(tids[i]);
+  }
+  EdfUtil = 0;
+
+  return misses;
+}
+
+int EdfTest(uval32 ticks)
+{
+  EdfParams probe;
+  int i, misses, failed = 0;
+  sval32 tid;
+  bool ok;
+
+  printf("%-20s %8s %8s\n", "set", "jobs", "misses");
+  for (i = 0; i < sizeof(Sets) / sizeof(Sets[0]); i++) {
+    uval32 jobs = 0;
+    int t;
+
+    for (t = 0; t < Sets[i].count; t++) {
+      jobs += ticks / Sets[i].task[t].period;
+    }
+    misses = Run(&Sets[i], ticks);
+    ok = misses >= 0 && (Sets[i].overloaded ? misses > 0 : misses == 0);
+    printf("%-20s %8u %8d%s\n", Sets[i].name, jobs, misses, 
+	   ok ? "" : "  FAILED");
+    failed += !ok;
+  }
+
+  // Admission control alone must turn the overloaded set away.
+  for (i = 0; i < sizeof(Sets) / sizeof(Sets[0]); i++) {
+    if (Sets[i].overloaded) {
+      ThreadId tids[EDFTEST_MAX_TASKS];
+      int t, admitted = 0;
+
+      for (t = 0; t < Sets[i].count; t++) {
+	probe = Sets[i].task[t];
+	if ((tid = CreateEdfThread((uval32) (uvalptr) WorkloadNop, &probe)) > OK) {
+	  tids[admitted++] = tid;
+	}
+      }
+      for (t = 0; t < admitted; t++) {
+	DestroyThread(tids[t]);
+      }
+      ok = admitted < Sets[i].count;
+      printf("%s admitted %d of %d tasks%s\n", Sets[i].name, admitted, 
+	     Sets[i].count, ok ? "" : "  FAILED");
+      failed += !ok;
+    }
+  }
+
+  printf("%s\n", failed ? "FAILED" : "OK");
+  return failed ? 1 : 0;
+}
+
+#endif /* NATIVE */
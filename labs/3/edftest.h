@@ -0,0 +1,19 @@
+#ifndef _EDFTEST_H_
+#define _EDFTEST_H_
+
+#include "defines.h"
+
+// EDF schedulability test, x86 build only. With KEDFTEST=<ticks> in the 
+// environment prog runs task sets of growing utilization for <ticks> 
+// simulated timer ticks each, every job using its whole budget, and 
+// counts deadline misses. Sets with utilization up to 1 must not miss; 
+// overloaded ones, admitted by skipping admission control, must. Exits 
+// non-zero otherwise.
+#define EDFTEST_ENV "KEDFTEST"
+#define EDFTEST_MAX_TASKS 4
+
+#ifndef NATIVE
+int EdfTest(uval32 ticks);
+#endif /* NATIVE */
+
+#endif
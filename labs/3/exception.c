@@ -1,6 +1,8 @@
 #include "defines.h"
 #include "main.h"
 #include "kernel.h"
+#include "io.h"
+#include "clock.h"
 
 #ifdef NATIVE
 /* The assembly language code below handles CPU reset processing */
@@ -40,64 +42,179 @@ void the_isr (void)
   //Hardware Interrupt
   asm ("SKIP_EA_DEC:");
   SAVE_REGS;
+  // interrupt_handler() lets more urgent interrupts in, which reuse ea 
+  // and estatus. ea is in the frame already, keep estatus in its spare
+  // first word.
+  asm (	"rdctl	et,  ctl1");
+  asm (	"stw	et,  0(sp)");
   asm (	"addi	fp,  sp, 128");
+  asm (	"mov	r4,  ea");		/* interrupted pc, for the profiler */
   asm (	"call	interrupt_handler");// Call the interrupt handler
+  asm (	"ldw	et,  0(sp)");
+  asm (	"wrctl	ctl1, et");
+
+  // If the handler made a more urgent thread ready, and we interrupted 
+  // a thread rather than the kernel or another handler, switch to it. The interrupted 
+  // thread's frame is already on its stack, in the same layout a 
+  // system call leaves, so it can be resumed by SOFT_INT_EXIT later.
+  asm ( "ldw	et,  %0" : : "m" (NeedResched));
+  asm ( "beq	et,  r0, HW_INT_EXIT");
+  asm ( "rdctl	et,  ctl1");
+  asm ( "andi	et,  et, 2");		/* estatus.U */
+  asm ( "beq	et,  r0, HW_INT_EXIT");
+  // A thread switched out inside AtomicCas() starts it over. The frame 
+  // holds r8-r10, so they are free here.
+  asm ( "ldw	r8,  108(sp)");		/* interrupted pc */
+  asm ( "movia	r9,  AtomicCasBegin");
+  asm ( "bltu	r8,  r9, RAS_DONE");
+  asm ( "movia	r10, AtomicCasEnd");
+  asm ( "bgeu	r8,  r10, RAS_DONE");
+  asm ( "stw	r9,  108(sp)");
+  asm ("RAS_DONE:");
+  MOVE_SP_TO_ACTIVE;
+  MOVE_SR_TO_ACTIVE;
+  asm ( "call	Preempt");
+  MOVE_ACTIVE_TO_SP;
+  MOVE_ACTIVE_TO_SR;
+
+  asm ("HW_INT_EXIT:");
   LOAD_REGS;
   asm (	"addi	sp,  sp, 116");
   asm (	"eret");
 
   //Software Interrupt - Trap OR Illegal Insruction(not handled)
   asm ("SOFT_INT:");
-  // If there is no SYS_* parameter, i.e. we have SYS_EXIT, 
-  // go to soft_int_exit.
-  asm ("bne r8, r0, SOFT_INT_EXIT");
 
   //System call enter - go to kernel
   asm ("SOFT_INT_ENTER:");
-  // Save context
+  // Save context. ea is the instruction after the trap, so the frame 
+  // returns past it.
   SAVE_REGS;
 
-  // Move the kernel's sp, pc and sr to active thread,
-  // since we are entering a syscall.
-  // When is kernel's sp stored in r27?
+  // Save the caller's sp, pc and sr in its TD, and move to the kernel's 
+  // stack. K_SysCall() runs in exception mode; r4-r7 are its arguments.
   MOVE_SP_TO_ACTIVE;
   MOVE_PC_TO_ACTIVE;
   MOVE_SR_TO_ACTIVE;
 
-  SET_KERNEL_PC;
   SET_KERNEL_SP;
   SET_KERNEL_FP;
-  SET_KERNEL_SR;
   
-  // Call C routine to do work
+  // Call C routine to do work. It returns once it has decided who runs 
+  // next, with the caller's result already in the r2 slot of its frame.
   asm ( "call K_SysCall");
 
-  
-  // Restore context
-  //LOAD_REGS
-
-  // Return from K_SysCall. Context already restored, 
-  // so return from exception to user space of trap in 
-  // SysCall.
-  asm (	"eret" );
-
-  //System call exit - exit kernel, go to user
+  //System call exit - exit kernel, go to user. Also where a thread 
+  // switched out by an interrupt is resumed from.
   asm ("SOFT_INT_EXIT:");
-  MOVE_ACTIVE_TO_PC;
   MOVE_ACTIVE_TO_SP;
   MOVE_ACTIVE_TO_SR;
-  // Done with C routine. Restore context, as done 
-  // in seminar3.pdf p 3. 
+  // Restore context, as done in seminar3.pdf p 3. ea comes back from 
+  // the frame.
   LOAD_REGS;
   asm ( "addi sp,  sp, 116");
-  // Return from exception to user space from trap in K_SysCall
+  // Return from exception to user space: the only eret of the call
   asm ( "eret" );    
 }
 
 
 #endif /* NATIVE */
 
-void interrupt_handler(void)
+typedef struct type_IRQ_LINE IrqLine;
+
+struct type_IRQ_LINE
+{
+  IrqIsr isr;
+  int priority;
+  // Lines whose priority is above this one's.
+  uval32 above;
+};
+
+static IrqLine Irqs[NUM_IRQS];
+// Lines with a handler, most urgent first.
+static int IrqOrder[NUM_IRQS];
+static int NumIrqs;
+
+IrqStat IrqStats[NUM_IRQS];
+volatile uval32 IrqRaisedAt[NUM_IRQS];
+bool IrqNest = TRUE;
+
+// Installs isr for irq at the given priority and unmasks the line.
+void RequestIrq(int irq, int priority, IrqIsr isr)
 {
+  int i, j;
+
+  Irqs[irq].isr = isr;
+  Irqs[irq].priority = priority;
+
+  for (i = 0; i < NumIrqs && Irqs[IrqOrder[i]].priority <= priority; i++);
+  for (j = NumIrqs; j > i; j--) {
+    IrqOrder[j] = IrqOrder[j - 1];
+  }
+  IrqOrder[i] = irq;
+  NumIrqs++;
+
+  for (i = 0; i < NumIrqs; i++) {
+    Irqs[IrqOrder[i]].above = 0;
+    for (j = 0; j < i; j++) {
+      if (Irqs[IrqOrder[j]].priority < Irqs[IrqOrder[i]].priority) {
+	Irqs[IrqOrder[i]].above |= (1 << IrqOrder[j]);
+      }
+    }
+  }
+
+  EnableIrq(irq);
+}
+
+static void IrqLatency(int irq)
+{
+  IrqStat *stat = &IrqStats[irq];
+  uval32 latency;
+
+  if (!IrqRaisedAt[irq]) {
+    return;
+  }
+  latency = ReadClock() - IrqRaisedAt[irq];
+  IrqRaisedAt[irq] = 0;
+
+  stat->count++;
+  stat->total += latency;
+  if (latency > stat->max) {
+    stat->max = latency;
+  }
+}
+
+// Dispatches pending device interrupts to their drivers, most urgent 
+// first. pc is the address of the interrupted instruction. Entered with 
+// interrupts off; each handler runs with only the more urgent lines 
+// unmasked, so it can be interrupted by them, and interrupts are off 
+// again on return. Rescheduling is left to the outermost the_isr.
+void interrupt_handler(uvalptr pc)
+{
+  uval32 pending;
+  uval32 enabled;
+  int i, irq;
+
+  while ((pending = IrqPending()) != 0) {
+    for (i = 0; i < NumIrqs && !(pending & (1 << IrqOrder[i])); i++);
+    if (i == NumIrqs) {
+      // Nothing we have a handler for.
+      return;
+    }
+    irq = IrqOrder[i];
+
+    IrqAck(irq);
+    IrqLatency(irq);
 
+    if (IrqNest) {
+      enabled = IrqSetMask(0);
+      IrqSetMask(enabled & Irqs[irq].above);
+      IrqUnlock(TRUE);
+      Irqs[irq].isr(pc);
+      IrqLock();
+      IrqSetMask(enabled);
+    } else {
+      Irqs[irq].isr(pc);
+    }
+  }
 }
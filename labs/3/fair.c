@@ -0,0 +1,226 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "fair.h"
+
+#include <stdlib.h>
+
+LL* FairQ;
+
+// Root of the pairing heap of ready fair threads, least vruntime first.
+static TD *FairRoot;
+
+// Never more than the vruntime of any ready or running fair thread, and 
+// only moves forward. New and woken threads start from here, so they 
+// cannot claim the CPU time they were not around for.
+static uval32 MinVruntime;
+
+// vruntime comparison that survives wrap-around.
+#define VR_BEFORE(a, b) ((int) ((a) - (b)) < 0)
+
+// Melds two heaps whose roots have no siblings. The root with the larger 
+// vruntime becomes the leftmost child of the other.
+static TD *Meld(TD *a, TD *b)
+{
+  TD *tmp;
+
+  if (!a) {
+    return b;
+  } else if (!b) {
+    return a;
+  }
+
+  if (VR_BEFORE(b->vruntime, a->vruntime)) {
+    tmp = a;
+    a = b;
+    b = tmp;
+  }
+
+  b->fair.prev = a;
+  b->fair.sibling = a->fair.child;
+  if (a->fair.child) {
+    a->fair.child->fair.prev = b;
+  }
+  a->fair.child = b;
+
+  return a;
+}
+
+// Melds a list of sibling heaps into one: pairs left to right, then the 
+// pairs right to left. This is what keeps deletion O(log n) amortized.
+static TD *MergePairs(TD *first)
+{
+  TD *pairs = NULL;
+  TD *root = NULL;
+  TD *a, *b, *next;
+
+  while (first) {
+    a = first;
+    b = a->fair.sibling;
+    next = b ? b->fair.sibling : NULL;
+
+    a->fair.sibling = NULL;
+    a->fair.prev = NULL;
+    if (b) {
+      b->fair.sibling = NULL;
+      b->fair.prev = NULL;
+    }
+
+    a = Meld(a, b);
+    a->fair.sibling = pairs;
+    pairs = a;
+    first = next;
+  }
+
+  while (pairs) {
+    next = pairs->fair.sibling;
+    pairs->fair.sibling = NULL;
+    root = Meld(root, pairs);
+    pairs = next;
+  }
+
+  return root;
+}
+
+// Moves MinVruntime up to the least vruntime among the heap and td.
+static void UpdateMin(TD *td)
+{
+  uval32 min;
+
+  if (FairRoot && (!td || VR_BEFORE(FairRoot->vruntime, td->vruntime))) {
+    min = FairRoot->vruntime;
+  } else if (td) {
+    min = td->vruntime;
+  } else {
+    return;
+  }
+
+  if (VR_BEFORE(MinVruntime, min)) {
+    MinVruntime = min;
+  }
+}
+
+void InitFair(void)
+{
+  FairQ = CreateList(L_FAIR);
+  FairRoot = NULL;
+  MinVruntime = 0;
+}
+
+// Creates a thread in the fair class with the given weight, 0 meaning 
+// FAIR_WEIGHT_DEFAULT, and returns its tid.
+sval32 CreateFairThread(uval32 pc, uval32 weight)
+{
+  TD *thread;
+  T_RC rc;
+
+  if (weight == 0) {
+    weight = FAIR_WEIGHT_DEFAULT;
+  } else if (weight > FAIR_WEIGHT_MAX) {
+    return PRIORITY_ERROR;
+  }
+
+  if ((rc = AllocThread(pc, FAIR_PRIORITY, &thread)) != OK) {
+    return rc;
+  }
+
+  thread->sched = SCHED_FAIR;
+  thread->fair.weight = weight;
+  thread->vruntime = MinVruntime;
+  MakeReady(thread);
+
+  if (RunsBefore(thread, Active)) {
+    Yield();
+  }
+  return thread->tid;
+}
+
+// Inserts td, which is on no list, into the heap. A thread coming back 
+// from a long sleep is placed no more than FAIR_GRANULARITY ahead of the 
+// others.
+void FairEnqueue(TD *td)
+{
+  if (VR_BEFORE(td->vruntime, MinVruntime - FAIR_GRANULARITY)) {
+    td->vruntime = MinVruntime - FAIR_GRANULARITY;
+  }
+
+  td->fair.child = NULL;
+  td->fair.sibling = NULL;
+  td->fair.prev = NULL;
+  td->inlist = FairQ;
+
+  FairRoot = Meld(FairRoot, td);
+}
+
+// Removes and returns the ready fair thread with the least vruntime.
+TD *FairDequeueMin(void)
+{
+  TD *td = FairRoot;
+
+  if (!td) {
+    return NULL;
+  }
+
+  FairRoot = MergePairs(td->fair.child);
+  td->fair.child = NULL;
+  td->inlist = NULL;
+
+  UpdateMin(td);
+  return td;
+}
+
+TD *FairPeek(void)
+{
+  return FairRoot;
+}
+
+// Takes td, which is in the heap, out of it.
+void FairRemove(TD *td)
+{
+  TD *sub;
+
+  if (td == FairRoot) {
+    FairDequeueMin();
+    return;
+  }
+
+  if (td->fair.prev->fair.child == td) {
+    td->fair.prev->fair.child = td->fair.sibling;
+  } else {
+    td->fair.prev->fair.sibling = td->fair.sibling;
+  }
+  if (td->fair.sibling) {
+    td->fair.sibling->fair.prev = td->fair.prev;
+  }
+
+  sub = MergePairs(td->fair.child);
+  td->fair.child = NULL;
+  td->fair.sibling = NULL;
+  td->fair.prev = NULL;
+  td->inlist = NULL;
+
+  FairRoot = Meld(FairRoot, sub);
+}
+
+// Whether fair thread td is far enough behind other to preempt it.
+bool FairBefore(TD *td, TD *other)
+{
+  return VR_BEFORE(td->vruntime + FAIR_GRANULARITY, other->vruntime);
+}
+
+// Called on every timer tick. Charges the running fair thread for the 
+// tick in proportion to its weight, and asks for a switch once another 
+// fair thread has fallen too far behind it.
+void FairTick(void)
+{
+  if (Active->sched != SCHED_FAIR) {
+    return;
+  }
+
+  Active->vruntime += FAIR_TICK_VRUNTIME * FAIR_WEIGHT_DEFAULT / Active->fair.weight;
+  UpdateMin(Active);
+
+  if (FairRoot && FairBefore(FairRoot, Active)) {
+    NeedResched = TRUE;
+  }
+}
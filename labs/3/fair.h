@@ -0,0 +1,34 @@
+#ifndef _FAIR_H_
+#define _FAIR_H_
+
+#include "defines.h"
+#include "list.h"
+
+// Fair threads run as one band at this priority: after every priority 
+// class thread above it, ahead of the idle thread.
+#define FAIR_PRIORITY (MIN_PRIORITY - 1)
+
+// Weight of a thread with an ordinary share of the CPU. A thread of 
+// weight w gets w/FAIR_WEIGHT_DEFAULT times the CPU time of such a thread.
+#define FAIR_WEIGHT_DEFAULT 1024
+#define FAIR_WEIGHT_MAX (64 * FAIR_WEIGHT_DEFAULT)
+
+// vruntime a thread of default weight gains per tick.
+#define FAIR_TICK_VRUNTIME 1024
+// How far behind the running thread the most starved one may fall 
+// before it preempts it.
+#define FAIR_GRANULARITY FAIR_TICK_VRUNTIME
+
+// Marks fair threads in the heap in their inlist; never holds TDs itself.
+extern LL* FairQ;
+
+void InitFair(void);
+sval32 CreateFairThread(uval32 pc, uval32 weight);
+void FairEnqueue(TD *td);
+TD *FairDequeueMin(void);
+TD *FairPeek(void);
+void FairRemove(TD *td);
+bool FairBefore(TD *td, TD *other);
+void FairTick(void);
+
+#endif
@@ -0,0 +1,67 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "clock.h"
+#include "fair.h"
+#include "workload.h"
+#include "fairbench.h"
+
+#ifndef NATIVE
+
+#include <stdio.h>
+
+static uval32 Weights[FAIRBENCH_WEIGHTS] = {
+  FAIR_WEIGHT_DEFAULT / 2, FAIR_WEIGHT_DEFAULT, 2 * FAIR_WEIGHT_DEFAULT, 
+  4 * FAIR_WEIGHT_DEFAULT
+};
+
+// Ticks each thread was running when the timer went off.
+static uval32 Ran[NUM_TID + 1];
+
+int FairBench(uval32 ticks)
+{
+  ThreadId tids[FAIRBENCH_THREADS];
+  uval32 total = 0, sum, min, max;
+  double owed, got;
+  int i, w;
+  sval32 tid;
+
+  for (i = 0; i < FAIRBENCH_THREADS; i++) {
+    if ((tid = CreateFairThread((uval32) (uvalptr) WorkloadNop, 
+				Weights[i % FAIRBENCH_WEIGHTS])) < OK) {
+      printf("could not create thread %d\n", i);
+      return 1;
+    }
+    tids[i] = tid;
+    total += Weights[i % FAIRBENCH_WEIGHTS];
+  }
+
+  for (i = 0; i < ticks; i++) {
+    Ran[Active->tid]++;
+    WorkloadTick();
+  }
+
+  printf("%d threads, %u ticks\n", FAIRBENCH_THREADS, ticks);
+  printf("%8s %10s %10s %10s %10s\n", "weight", "owed %", "got %", 
+	 "min ticks", "max ticks");
+  for (w = 0; w < FAIRBENCH_WEIGHTS; w++) {
+    sum = 0;
+    min = ~0;
+    max = 0;
+    for (i = w; i < FAIRBENCH_THREADS; i += FAIRBENCH_WEIGHTS) {
+      sum += Ran[tids[i]];
+      min = Ran[tids[i]] < min ? Ran[tids[i]] : min;
+      max = Ran[tids[i]] > max ? Ran[tids[i]] : max;
+    }
+    owed = 100.0 * Weights[w] * (FAIRBENCH_THREADS / FAIRBENCH_WEIGHTS) / total;
+    got = 100.0 * sum / ticks;
+    printf("%8u %10.2f %10.2f %10u %10u\n", Weights[w], owed, got, min, max);
+  }
+
+  for (i = 0; i < FAIRBENCH_THREADS; i++) {
+    DestroyThread(tids[i]);
+  }
+  return 0;
+}
+
+#endif /* NATIVE */
@@ -0,0 +1,19 @@
+#ifndef _FAIRBENCH_H_
+#define _FAIRBENCH_H_
+
+#include "defines.h"
+
+// Fair class benchmark, x86 build only. With KFAIRBENCH=<ticks> in the 
+// environment prog runs FAIRBENCH_THREADS CPU-bound fair threads, spread 
+// evenly over FAIRBENCH_WEIGHTS weights, for <ticks> simulated timer 
+// ticks, and prints the CPU share each weight got against the share it 
+// is owed, and the spread between threads of the same weight.
+#define FAIRBENCH_ENV "KFAIRBENCH"
+#define FAIRBENCH_THREADS 128
+#define FAIRBENCH_WEIGHTS 4
+
+#ifndef NATIVE
+int FairBench(uval32 ticks);
+#endif /* NATIVE */
+
+#endif
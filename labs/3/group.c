@@ -0,0 +1,257 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "sched.h"
+#include "kinfo.h"
+#include "klog.h"
+#include "waitq.h"
+#include "latency.h"
+#include "group.h"
+
+static Group Groups[MAX_GROUPS];
+// Members being moved on or off the ready queue by one operation.
+static TD *Batch[NUM_TID];
+
+void InitGroups(void)
+{
+  int i;
+
+  for (i = 0; i < MAX_GROUPS; i++) {
+    Groups[i].used = FALSE;
+  }
+}
+
+static Group *Lookup(int group)
+{
+  if ((group < 0) || (group >= MAX_GROUPS) || !Groups[group].used) {
+    return NULL;
+  }
+  return &Groups[group];
+}
+
+static void Join(int group, TD *td)
+{
+  Group *g = &Groups[group];
+
+  td->cold->group = group;
+  td->cold->groupPrev = NULL;
+  td->cold->groupNext = g->members;
+  if (g->members) {
+    g->members->cold->groupPrev = td;
+  }
+  g->members = td;
+  g->count++;
+}
+
+// Takes td out of its group, if any. Called when it is destroyed.
+void GroupExit(TD *td)
+{
+  Group *g;
+
+  if (td->cold->group < 0) {
+    return;
+  }
+  g = &Groups[td->cold->group];
+
+  if (td->cold->groupPrev) {
+    td->cold->groupPrev->cold->groupNext = td->cold->groupNext;
+  } else {
+    g->members = td->cold->groupNext;
+  }
+  if (td->cold->groupNext) {
+    td->cold->groupNext->cold->groupPrev = td->cold->groupPrev;
+  }
+  td->cold->group = -1;
+  g->count--;
+}
+
+// Creates an empty group and stores its id in *group.
+T_RC GroupCreate(int *group)
+{
+  int i;
+
+  for (i = 0; i < MAX_GROUPS; i++) {
+    if (!Groups[i].used) {
+      Groups[i].used = TRUE;
+      Groups[i].count = 0;
+      Groups[i].members = NULL;
+      *group = i;
+      return OK;
+    }
+  }
+  return RESOURCE_ERROR;
+}
+
+// As CreateThread(), with the new thread a member of group.
+sval32 GroupCreateThread(int group, uval32 pc, uval32 priority)
+{
+  TD *thread;
+  T_RC rc;
+
+  if (!Lookup(group)) {
+    return FAILED;
+  } else if ((priority < 1) || (priority > MIN_PRIORITY)) {
+    return PRIORITY_ERROR;
+  } else if ((rc = AllocThread(pc, priority, &thread)) != OK) {
+    return rc;
+  }
+  Join(group, thread);
+  MakeReady(thread);
+
+  KLOG_DEBUG(KLOG_CREATE_THREAD, thread->tid, priority, 0);
+
+  if (RunsBefore(thread, Active)) {
+    Yield();
+  }
+  return thread->tid;
+}
+
+// Blocks every member that is ready, as if it had called Suspend(). 
+// Members blocked on something else are left alone. If Active is a 
+// member it is suspended last.
+static void SuspendAll(Group *g)
+{
+  TD *td;
+  int i, n = 0;
+
+  for (td = g->members; td; td = td->cold->groupNext) {
+    if (td->inlist == ReadyQ) {
+      Batch[n++] = td;
+    } else if (td != Active && td->inlist != WaitQ) {
+      Unqueue(td);
+      WaitqBlock(td, td);
+    }
+  }
+
+  Sched->removeBatch(Batch, n);
+  for (i = 0; i < n; i++) {
+    WaitqBlock(Batch[i], Batch[i]);
+  }
+
+  if (Active->cold->group == g - Groups) {
+    WaitOn(Active);
+  }
+}
+
+// Makes every suspended member ready.
+static void ResumeAll(Group *g)
+{
+  TD *td, *best = NULL;
+  int n = 0;
+
+  for (td = g->members; td; td = td->cold->groupNext) {
+    if (!WaitingOn(td, td)) {
+      continue;
+    }
+    WaitqRemove(td);
+    if (td->sched == SCHED_PRIORITY) {
+      LAT_READY(td);
+      Batch[n++] = td;
+    } else {
+      MakeReady(td);
+    }
+    if (!best || RunsBefore(td, best)) {
+      best = td;
+    }
+  }
+
+  Sched->enqueueBatch(Batch, n);
+  if (best && RunsBefore(best, Active)) {
+    Yield();
+  }
+}
+
+// Moves every priority class member to priority.
+static void Reprioritise(Group *g, uval32 priority)
+{
+  TD *td, *next;
+  int i, n = 0;
+
+  for (td = g->members; td; td = td->cold->groupNext) {
+    if (td->sched != SCHED_PRIORITY) {
+      continue;
+    } else if (td->inlist == ReadyQ) {
+      Batch[n++] = td;
+      continue;
+    }
+    td->priority = priority;
+    if (td == Active) {
+      KInfoPage.priority = priority;
+    } else if (td->inlist == WaitQ) {
+      WaitqRequeue(td);
+    }
+  }
+
+  Sched->removeBatch(Batch, n);
+  for (i = 0; i < n; i++) {
+    Batch[i]->priority = priority;
+  }
+  Sched->enqueueBatch(Batch, n);
+
+  if ((next = Sched->peek()) && RunsBefore(next, Active)) {
+    Yield();
+  }
+}
+
+// Destroys every member and the group. If Active is a member it goes 
+// last, and the next thread is dispatched.
+static void DestroyAll(Group *g)
+{
+  TD *td, *next;
+  bool self = FALSE;
+  int n = 0;
+
+  for (td = g->members; td; td = td->cold->groupNext) {
+    if (td->inlist == ReadyQ) {
+      Batch[n++] = td;
+    }
+  }
+  // The batch still says ReadyQ afterwards, but is on no queue.
+  Sched->removeBatch(Batch, n);
+
+  for (td = g->members; td; td = next) {
+    next = td->cold->groupNext;
+    if (td == Active) {
+      self = TRUE;
+      continue;
+    } else if (td->inlist != ReadyQ) {
+      Unqueue(td);
+    }
+    ReleaseThread(td);
+  }
+
+  g->used = FALSE;
+  if (self) {
+    DestroyThread(0);
+  }
+}
+
+// SYS_GROUP_CTL: applies op to every member of group. arg is the new 
+// priority for GROUP_PRIORITY.
+T_RC GroupControl(int group, GroupOp op, uval32 arg)
+{
+  Group *g;
+
+  if ((g = Lookup(group)) == NULL) {
+    return FAILED;
+  }
+
+  switch (op) {
+  case GROUP_SUSPEND:
+    SuspendAll(g);
+    return OK;
+  case GROUP_RESUME:
+    ResumeAll(g);
+    return OK;
+  case GROUP_PRIORITY:
+    if ((arg < 1) || (arg > MIN_PRIORITY)) {
+      return PRIORITY_ERROR;
+    }
+    Reprioritise(g, arg);
+    return OK;
+  case GROUP_DESTROY:
+    DestroyAll(g);
+    return OK;
+  }
+  return FAILED;
+}
@@ -0,0 +1,30 @@
+#ifndef _GROUP_H_
+#define _GROUP_H_
+
+#include "defines.h"
+#include "list.h"
+
+// Thread groups. A thread is put in a group when it is created, and one 
+// SYS_GROUP_CTL then acts on every member: the ready queue is updated 
+// for all of them in one batch, and whether Active should give way is 
+// decided once at the end.
+#define MAX_GROUPS 16
+
+typedef enum { GROUP_SUSPEND, GROUP_RESUME, GROUP_PRIORITY, GROUP_DESTROY } GroupOp;
+
+typedef struct type_GROUP Group;
+
+struct type_GROUP
+{
+  bool used;
+  uval32 count;
+  TD *members;
+};
+
+void InitGroups(void);
+T_RC GroupCreate(int *group);
+sval32 GroupCreateThread(int group, uval32 pc, uval32 priority);
+T_RC GroupControl(int group, GroupOp op, uval32 arg);
+void GroupExit(TD *td);
+
+#endif
@@ -0,0 +1,309 @@
+#include "defines.h"
+#include "user.h"
+#include "heap.h"
+
+#include <string.h>
+
+typedef struct type_HEAP_BLOCK HeapBlock;
+
+// Header of every block. The free list links are only valid while the 
+// block is free, and take up the start of its payload otherwise.
+struct type_HEAP_BLOCK
+{
+  // The block before in memory, or null for the first.
+  HeapBlock *prevPhys;
+  // Bytes of payload, with BLOCK_FREE in the low bit.
+  uvalptr size;
+  HeapBlock *nextFree;
+  HeapBlock *prevFree;
+};
+
+#define BLOCK_FREE 1
+#define BLOCK_HEADER ((uvalptr) &((HeapBlock *) 0)->nextFree)
+// Room for the free list links.
+#define BLOCK_MIN (sizeof(HeapBlock) - BLOCK_HEADER)
+
+static uval8 Arena[HEAP_SIZE] __attribute__ ((aligned (HEAP_ALIGN)));
+
+// Bit fl of FlMap is set if any list of range fl is non-empty, and bit sl
+// of SlMap[fl] if Free[fl][sl] is.
+static uval32 FlMap;
+static uval32 SlMap[HEAP_FL_COUNT];
+static HeapBlock *Free[HEAP_FL_COUNT][HEAP_SL_COUNT];
+
+static HeapStats Stats;
+
+static uval32 SizeOf(HeapBlock *b)
+{
+  return b->size & ~BLOCK_FREE;
+}
+
+static bool IsFree(HeapBlock *b)
+{
+  return b->size & BLOCK_FREE;
+}
+
+static HeapBlock *NextPhys(HeapBlock *b)
+{
+  return (HeapBlock *) ((uval8 *) b + BLOCK_HEADER + SizeOf(b));
+}
+
+static int Msb(uval32 x)
+{
+  return 31 - __builtin_clz(x);
+}
+
+// The list that blocks of size bytes belong in.
+static void Mapping(uval32 size, int *fl, int *sl)
+{
+  int msb;
+
+  if (size < HEAP_SMALL) {
+    *fl = 0;
+    *sl = size >> HEAP_ALIGN_SHIFT;
+  } else {
+    msb = Msb(size);
+    *fl = msb - HEAP_FL_SHIFT + 1;
+    *sl = (size >> (msb - HEAP_SL_BITS)) ^ HEAP_SL_COUNT;
+  }
+}
+
+static void Insert(HeapBlock *b)
+{
+  uval32 size = SizeOf(b);
+  int fl, sl;
+
+  Mapping(size, &fl, &sl);
+  b->prevFree = NULL;
+  b->nextFree = Free[fl][sl];
+  if (b->nextFree) {
+    b->nextFree->prevFree = b;
+  }
+  Free[fl][sl] = b;
+  FlMap |= 1 << fl;
+  SlMap[fl] |= 1 << sl;
+
+  b->size |= BLOCK_FREE;
+  Stats.freeBytes += size;
+  Stats.freeBlocks[fl]++;
+}
+
+static void Remove(HeapBlock *b)
+{
+  uval32 size = SizeOf(b);
+  int fl, sl;
+
+  Mapping(size, &fl, &sl);
+  if (b->prevFree) {
+    b->prevFree->nextFree = b->nextFree;
+  } else {
+    Free[fl][sl] = b->nextFree;
+    if (!Free[fl][sl]) {
+      SlMap[fl] &= ~(1 << sl);
+      if (!SlMap[fl]) {
+	FlMap &= ~(1 << fl);
+      }
+    }
+  }
+  if (b->nextFree) {
+    b->nextFree->prevFree = b->prevFree;
+  }
+
+  b->size &= ~BLOCK_FREE;
+  Stats.freeBytes -= size;
+  Stats.freeBlocks[fl]--;
+}
+
+// A free block of at least size bytes, or null. Rounding size up to the
+// next list boundary first means any block of the list found will do, 
+// so there is no search within a list.
+static HeapBlock *Find(uval32 size)
+{
+  uval32 map;
+  int fl, sl;
+
+  if (size >= HEAP_SMALL) {
+    size += (1 << (Msb(size) - HEAP_SL_BITS)) - 1;
+  }
+  Mapping(size, &fl, &sl);
+  if (fl >= HEAP_FL_COUNT) {
+    return NULL;
+  }
+
+  map = SlMap[fl] & (~0u << sl);
+  if (!map) {
+    if (fl + 1 >= HEAP_FL_COUNT || !(map = FlMap & (~0u << (fl + 1)))) {
+      return NULL;
+    }
+    fl = __builtin_ctz(map);
+    map = SlMap[fl];
+  }
+  return Free[fl][__builtin_ctz(map)];
+}
+
+// Makes the whole arena one free block, followed by an empty block that
+// is never free so that every block has a successor.
+void InitHeap(void)
+{
+  HeapBlock *b = (HeapBlock *) Arena;
+  HeapBlock *end;
+  int i;
+
+  FlMap = 0;
+  for (i = 0; i < HEAP_FL_COUNT; i++) {
+    SlMap[i] = 0;
+  }
+  memset(&Stats, 0, sizeof(Stats));
+  Stats.size = HEAP_SIZE - 2 * BLOCK_HEADER;
+
+  b->prevPhys = NULL;
+  b->size = Stats.size;
+  end = NextPhys(b);
+  end->prevPhys = b;
+  end->size = 0;
+  Insert(b);
+}
+
+// Returns size bytes aligned to HEAP_ALIGN, or null if there is no free
+// block big enough.
+void *HeapAlloc(uval32 size)
+{
+  HeapBlock *b, *rest;
+
+  if (size > HEAP_SIZE) {
+    Stats.failures++;
+    return NULL;
+  }
+  size = (size + HEAP_ALIGN - 1) & ~(HEAP_ALIGN - 1);
+  if (size < BLOCK_MIN) {
+    size = BLOCK_MIN;
+  }
+
+  if ((b = Find(size)) == NULL) {
+    Stats.failures++;
+    return NULL;
+  }
+  Remove(b);
+
+  // Give back what is left over if it can hold a block of its own.
+  if (SizeOf(b) >= size + BLOCK_HEADER + BLOCK_MIN) {
+    rest = (HeapBlock *) ((uval8 *) b + BLOCK_HEADER + size);
+    rest->prevPhys = b;
+    rest->size = SizeOf(b) - size - BLOCK_HEADER;
+    NextPhys(rest)->prevPhys = rest;
+    b->size = size;
+    Insert(rest);
+  }
+
+  Stats.allocs++;
+  Stats.inUse += SizeOf(b);
+  if (Stats.inUse > Stats.highWater) {
+    Stats.highWater = Stats.inUse;
+  }
+  return (uval8 *) b + BLOCK_HEADER;
+}
+
+// Whether ptr is a block HeapAlloc() returned and that is not free yet.
+// A pointer into the middle of a block is caught by its "header" not 
+// fitting in with the block after it.
+static bool InUse(void *ptr)
+{
+  uval8 *p = ptr;
+  HeapBlock *b = (HeapBlock *) (p - BLOCK_HEADER);
+  HeapBlock *end = (HeapBlock *) (Arena + HEAP_SIZE - BLOCK_HEADER);
+
+  if (p < Arena + BLOCK_HEADER || p >= Arena + HEAP_SIZE ||
+      (p - Arena - BLOCK_HEADER) % HEAP_ALIGN != 0) {
+    return FALSE;
+  }
+  if (IsFree(b) || SizeOf(b) > (uval8 *) end - p) {
+    return FALSE;
+  }
+  return NextPhys(b)->prevPhys == b;
+}
+
+// Frees ptr from HeapAlloc(), merging it with free neighbours. Pointers
+// that are not in use are ignored.
+void HeapFree(void *ptr)
+{
+  HeapBlock *b, *next;
+
+  if (!ptr || !InUse(ptr)) {
+    return;
+  }
+  b = (HeapBlock *) ((uval8 *) ptr - BLOCK_HEADER);
+  Stats.frees++;
+  Stats.inUse -= SizeOf(b);
+
+  next = NextPhys(b);
+  if (IsFree(next)) {
+    Remove(next);
+    b->size += BLOCK_HEADER + SizeOf(next);
+    NextPhys(b)->prevPhys = b;
+  }
+  if (b->prevPhys && IsFree(b->prevPhys)) {
+    Remove(b->prevPhys);
+    b->prevPhys->size += BLOCK_HEADER + SizeOf(b);
+    b = b->prevPhys;
+    NextPhys(b)->prevPhys = b;
+  }
+  Insert(b);
+}
+
+// Only the largest free block needs looking for: it is in the highest 
+// non-empty list, which is all that is walked.
+void HeapGetStats(HeapStats *stats)
+{
+  HeapBlock *b;
+  int fl;
+
+  Stats.largestFree = 0;
+  if (FlMap) {
+    fl = Msb(FlMap);
+    for (b = Free[fl][Msb(SlMap[fl])]; b; b = b->nextFree) {
+      if (SizeOf(b) > Stats.largestFree) {
+	Stats.largestFree = SizeOf(b);
+      }
+    }
+  }
+  *stats = Stats;
+}
+
+// SYS_HEAP_ALLOC: stores the block in *ptr, or null and returns 
+// RESOURCE_ERROR.
+T_RC HeapAllocSys(uval32 size, void **ptr)
+{
+  *ptr = HeapAlloc(size);
+  return *ptr ? OK : RESOURCE_ERROR;
+}
+
+// SYS_HEAP_FREE: returns FAILED for a pointer HeapAlloc() did not 
+// return or that was freed already.
+T_RC HeapFreeSys(void *ptr)
+{
+  if (ptr && !InUse(ptr)) {
+    return FAILED;
+  }
+  HeapFree(ptr);
+  return OK;
+}
+
+T_RC HeapStatsSys(HeapStats *stats)
+{
+  HeapGetStats(stats);
+  return OK;
+}
+
+// For user threads.
+void *UserAlloc(uval32 size)
+{
+  void *ptr;
+
+  SysCall(SYS_HEAP_ALLOC, size, (uvalptr) &ptr, 0);
+  return ptr;
+}
+
+void UserFree(void *ptr)
+{
+  SysCall(SYS_HEAP_FREE, (uvalptr) ptr, 0, 0);
+}
@@ -0,0 +1,57 @@
+#ifndef _HEAP_H_
+#define _HEAP_H_
+
+#include "defines.h"
+
+// The kernel heap: one fixed region with a two-level segregated fit 
+// allocator (TLSF). Free blocks are kept in lists by size class, found 
+// through two levels of bitmaps, and merged with their neighbours when 
+// freed, so allocating and freeing take a bounded number of steps 
+// however full or fragmented the heap is.
+#ifdef NATIVE
+#define HEAP_SIZE (4 * 1024 * 1024)
+#else /* NATIVE */
+#define HEAP_SIZE (16 * 1024 * 1024)
+#endif /* NATIVE */
+
+// Every block is a multiple of HEAP_ALIGN bytes.
+#define HEAP_ALIGN_SHIFT 3
+#define HEAP_ALIGN (1 << HEAP_ALIGN_SHIFT)
+// Each power of two size range is split into HEAP_SL_COUNT lists.
+#define HEAP_SL_BITS 4
+#define HEAP_SL_COUNT (1 << HEAP_SL_BITS)
+// Blocks under HEAP_SMALL all fall into the first size range.
+#define HEAP_FL_SHIFT (HEAP_SL_BITS + HEAP_ALIGN_SHIFT)
+#define HEAP_SMALL (1 << HEAP_FL_SHIFT)
+#define HEAP_FL_COUNT (32 - HEAP_FL_SHIFT + 1)
+
+typedef struct type_HEAP_STATS HeapStats;
+
+// Sizes are in bytes of payload.
+struct type_HEAP_STATS
+{
+  uval32 size;
+  uval32 inUse;
+  uval32 highWater;
+  uval32 freeBytes;
+  uval32 largestFree;
+  uval32 allocs;
+  uval32 frees;
+  // Allocations that found no block big enough.
+  uval32 failures;
+  // Free blocks by size: [0] under HEAP_SMALL, [i] from 
+  // HEAP_SMALL << (i - 1) up to twice that.
+  uval32 freeBlocks[HEAP_FL_COUNT];
+};
+
+void InitHeap(void);
+void *HeapAlloc(uval32 size);
+void HeapFree(void *ptr);
+void HeapGetStats(HeapStats *stats);
+T_RC HeapAllocSys(uval32 size, void **ptr);
+T_RC HeapFreeSys(void *ptr);
+T_RC HeapStatsSys(HeapStats *stats);
+void *UserAlloc(uval32 size);
+void UserFree(void *ptr);
+
+#endif
@@ -0,0 +1,142 @@
+#include "defines.h"
+#include "heap.h"
+#include "heapbench.h"
+
+#ifndef NATIVE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static void *Live[HEAPBENCH_LIVE];
+
+typedef struct type_HEAPBENCH_RESULT HeapBenchResult;
+
+struct type_HEAPBENCH_RESULT
+{
+  unsigned long long total;
+  unsigned long long max;
+  // Allocations that failed.
+  uval32 failed;
+};
+
+static unsigned long long Nanoseconds(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static uval32 RandomSize(void)
+{
+  if (rand() % HEAPBENCH_LARGE_EVERY == 0) {
+    return STACKSIZE;
+  }
+  return 1 + rand() % HEAPBENCH_SMALL_MAX;
+}
+
+// Replaces a random live block ops times, timing each free and 
+// allocation on its own, and leaves the blocks allocated. The sequence 
+// only depends on the seed.
+static void Churn(uval32 ops, void *(*alloc)(size_t), void (*release)(void *),
+		  HeapBenchResult *r)
+{
+  unsigned long long start, spent;
+  uval32 i, size;
+  int slot;
+
+  r->total = 0;
+  r->max = 0;
+  r->failed = 0;
+
+  srand(1);
+  for (i = 0; i < HEAPBENCH_LIVE; i++) {
+    Live[i] = alloc(RandomSize());
+  }
+
+  for (i = 0; i < ops; i++) {
+    slot = rand() % HEAPBENCH_LIVE;
+    size = RandomSize();
+
+    start = Nanoseconds();
+    release(Live[slot]);
+    Live[slot] = alloc(size);
+    spent = Nanoseconds() - start;
+
+    r->total += spent;
+    if (spent > r->max) {
+      r->max = spent;
+    }
+    if (!Live[slot]) {
+      r->failed++;
+    }
+  }
+}
+
+static void Drain(void (*release)(void *))
+{
+  int i;
+
+  for (i = 0; i < HEAPBENCH_LIVE; i++) {
+    release(Live[i]);
+  }
+}
+
+static void *Alloc(size_t size)
+{
+  return HeapAlloc(size);
+}
+
+static void Print(char *name, uval32 ops, HeapBenchResult *r)
+{
+  printf("%-8s %12.1f %12llu %8u\n", name, (double) r->total / ops, r->max, 
+	 r->failed);
+}
+
+int HeapBench(uval32 ops)
+{
+  HeapBenchResult heap, libc;
+  HeapStats stats;
+  int i;
+
+  if (ops < 1) {
+    ops = 1;
+  }
+
+  // Run each once first, so that neither is charged for the host 
+  // faulting in its memory.
+  Churn(ops, malloc, free, &libc);
+  Drain(free);
+  Churn(ops, malloc, free, &libc);
+  Drain(free);
+  Churn(ops, Alloc, HeapFree, &heap);
+  Drain(HeapFree);
+  Churn(ops, Alloc, HeapFree, &heap);
+  HeapGetStats(&stats);
+  Drain(HeapFree);
+
+  printf("         free+alloc ns      worst ns   failed\n");
+  Print("heap", ops, &heap);
+  Print("malloc", ops, &libc);
+
+  printf("\nheap after churn: %u bytes, high water %u, %u allocs, %u "
+	 "failures\n", stats.size, stats.highWater, stats.allocs,
+	 stats.failures);
+  printf("in use %u, free %u, largest free block %u\n", stats.inUse,
+	 stats.freeBytes, stats.largestFree);
+  printf("free blocks by size:\n");
+  for (i = 0; i < HEAP_FL_COUNT; i++) {
+    if (stats.freeBlocks[i]) {
+      printf("  < %8u %8u\n", HEAP_SMALL << i, stats.freeBlocks[i]);
+    }
+  }
+
+  // Everything the benchmark freed should have merged back together.
+  HeapGetStats(&stats);
+  printf("after freeing: in use %u, largest free block %u\n", stats.inUse,
+	 stats.largestFree);
+  return 0;
+}
+
+#endif /* NATIVE */
@@ -0,0 +1,23 @@
+#ifndef _HEAPBENCH_H_
+#define _HEAPBENCH_H_
+
+#include "defines.h"
+
+// Allocator churn benchmark, x86 build only. With KHEAPBENCH=<ops> in 
+// the environment prog keeps HEAPBENCH_LIVE blocks of random sizes 
+// allocated, replacing a random one <ops> times, first with the kernel 
+// heap and then with the same sequence against malloc(). It prints the 
+// mean and worst time of an operation for both, and how fragmented the 
+// kernel heap is left.
+#define HEAPBENCH_ENV "KHEAPBENCH"
+#define HEAPBENCH_LIVE 1024
+// One block in HEAPBENCH_LARGE_EVERY is a thread stack sized block, the
+// others up to HEAPBENCH_SMALL_MAX bytes.
+#define HEAPBENCH_SMALL_MAX 512
+#define HEAPBENCH_LARGE_EVERY 16
+
+#ifndef NATIVE
+int HeapBench(uval32 ops);
+#endif /* NATIVE */
+
+#endif
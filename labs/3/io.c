@@ -0,0 +1,152 @@
+#include "defines.h"
+#include "io.h"
+
+IoMap Io;
+
+#ifndef NATIVE
+#include <signal.h>
+
+// Stand-in device registers for the x86 build.
+static uval32 MockTimer[TIMER_REGS];
+static uval32 MockPushbutton[PB_REGS];
+static uval8 MockLcd[LCD_REGS];
+
+// Stand-in interrupt controller: ienable, ipending and status.PIE. A line
+// is delivered as its IRQ_SIGNAL(), which stays blocked while the line is
+// masked.
+static uval32 HostIenable;
+static volatile uval32 HostPending;
+static bool HostPie = TRUE;
+
+static void HostSignals(void)
+{
+  sigset_t blocked, open;
+  int irq;
+
+  sigemptyset(&blocked);
+  sigemptyset(&open);
+  for (irq = 0; irq < NUM_IRQS && IRQ_SIGNAL(irq) <= SIGRTMAX; irq++) {
+    if (!HostPie || !(HostIenable & (1 << irq))) {
+      sigaddset(&blocked, IRQ_SIGNAL(irq));
+    } else {
+      sigaddset(&open, IRQ_SIGNAL(irq));
+    }
+  }
+  sigprocmask(SIG_BLOCK, &blocked, NULL);
+  sigprocmask(SIG_UNBLOCK, &open, NULL);
+}
+#endif /* NATIVE */
+
+// Points the device map at the real hardware, or at the mock registers
+// when compiled for x86.
+void InitIo(void)
+{
+#ifdef NATIVE
+  Io.timer = (volatile uval32 *) TIMER_BASE;
+  Io.pushbutton = (volatile uval32 *) PUSHBUTTON_BASE;
+  Io.lcd = (volatile uval8 *) LCD_BASE;
+#else /* NATIVE */
+  InitIoMock(MockTimer, MockPushbutton, MockLcd);
+#endif /* NATIVE */
+}
+
+// Points the device map at caller supplied memory.
+void InitIoMock(volatile uval32 *timer, volatile uval32 *pushbutton, volatile uval8 *lcd)
+{
+  Io.timer = timer;
+  Io.pushbutton = pushbutton;
+  Io.lcd = lcd;
+}
+
+// Unmasks irq in the processor's ienable register (ctl3).
+void EnableIrq(int irq)
+{
+#ifdef NATIVE
+  uval32 ienable;
+
+  asm volatile("rdctl %0, ctl3" : "=r" (ienable));
+  ienable |= (1 << irq);
+  asm volatile("wrctl ctl3, %0" : : "r" (ienable));
+#else /* NATIVE */
+  IrqSetMask(HostIenable | (1 << irq));
+#endif /* NATIVE */
+}
+
+// Lines that are both asserted and enabled (ipending, ctl4).
+uval32 IrqPending(void)
+{
+#ifdef NATIVE
+  uval32 ipending;
+
+  asm volatile("rdctl %0, ctl4" : "=r" (ipending));
+  return ipending;
+#else /* NATIVE */
+  return HostPending & HostIenable;
+#endif /* NATIVE */
+}
+
+// Replaces ienable, returning the old value.
+uval32 IrqSetMask(uval32 enabled)
+{
+  uval32 old;
+
+#ifdef NATIVE
+  asm volatile("rdctl %0, ctl3" : "=r" (old));
+  asm volatile("wrctl ctl3, %0" : : "r" (enabled));
+#else /* NATIVE */
+  old = HostIenable;
+  HostIenable = enabled;
+  HostSignals();
+#endif /* NATIVE */
+  return old;
+}
+
+// Turns interrupts off (status.PIE), returning whether they were on.
+bool IrqLock(void)
+{
+#ifdef NATIVE
+  uval32 status;
+
+  asm volatile("rdctl %0, ctl0" : "=r" (status));
+  asm volatile("wrctl ctl0, %0" : : "r" (status & ~1));
+  return status & 1;
+#else /* NATIVE */
+  bool old = HostPie;
+
+  HostPie = FALSE;
+  HostSignals();
+  return old;
+#endif /* NATIVE */
+}
+
+void IrqUnlock(bool enabled)
+{
+#ifdef NATIVE
+  uval32 status;
+
+  asm volatile("rdctl %0, ctl0" : "=r" (status));
+  asm volatile("wrctl ctl0, %0" : : "r" (enabled ? status | 1 : status & ~1));
+#else /* NATIVE */
+  HostPie = enabled;
+  HostSignals();
+#endif /* NATIVE */
+}
+
+// Called before irq's handler runs. The devices drop their lines when 
+// their handlers clear them, so there is nothing to do on the board.
+void IrqAck(int irq)
+{
+#ifndef NATIVE
+  HostPending &= ~(1 << irq);
+#endif /* NATIVE */
+}
+
+#ifndef NATIVE
+
+// What the interrupt controller does when a device asserts irq.
+void RaiseIrq(int irq)
+{
+  HostPending |= (1 << irq);
+}
+
+#endif /* NATIVE */
@@ -0,0 +1,108 @@
+#ifndef _IO_H_
+#define _IO_H_
+
+#include "defines.h"
+
+// Base addresses of the memory mapped devices on the DE2 board.
+#define TIMER_BASE      0x10002000
+#define PUSHBUTTON_BASE 0x10000050
+#define LCD_BASE        0x10003050
+
+// Interrupt request lines (bit positions in ienable/ipending).
+#define TIMER_IRQ      0
+#define PUSHBUTTON_IRQ 1
+#define NUM_IRQS       32
+
+// Interrupt priorities, lower is more urgent. A handler runs with 
+// interrupts enabled for the lines more urgent than its own, so the 
+// timer tick is never held up by a slow device.
+#define TIMER_IRQ_PRIORITY      0
+#define PUSHBUTTON_IRQ_PRIORITY 1
+
+// Interval timer: status, control, periodl, periodh, snapl, snaph. Only 
+// the low 16 bits of each register are used.
+#define TIMER_REGS 6
+// Pushbutton parallel port: data, direction, interruptmask, edgecapture.
+#define PB_REGS 4
+// Character LCD: instruction register, data register.
+#define LCD_REGS 2
+
+typedef struct type_IO_MAP IoMap;
+
+// All device accesses go through this map instead of fixed addresses, so
+// that the drivers can be pointed at an ordinary memory region on the host.
+struct type_IO_MAP
+{
+  volatile uval32 *timer;
+  volatile uval32 *pushbutton;
+  volatile uval8 *lcd;
+#ifndef NATIVE
+  // Called after every LCD register write, if set, so that tests can 
+  // follow what the display is sent.
+  void (*lcdWatch)(int reg, uval8 value);
+#endif /* NATIVE */
+};
+
+extern IoMap Io;
+
+#define TIMER_STATUS     (Io.timer[0])
+#define TIMER_CONTROL    (Io.timer[1])
+#define TIMER_PERIODL    (Io.timer[2])
+#define TIMER_PERIODH    (Io.timer[3])
+#define TIMER_SNAPL      (Io.timer[4])
+#define TIMER_SNAPH      (Io.timer[5])
+
+// TIMER_STATUS bits
+#define TIMER_TO   0x1
+// TIMER_CONTROL bits
+#define TIMER_ITO  0x1
+#define TIMER_CONT 0x2
+#define TIMER_START 0x4
+
+#define PB_INTERRUPTMASK (Io.pushbutton[2])
+#define PB_EDGECAPTURE   (Io.pushbutton[3])
+
+#define LCD_IR 0
+#define LCD_DR 1
+#define LCD_INSTRUCTION  (Io.lcd[LCD_IR])
+#define LCD_DATA         (Io.lcd[LCD_DR])
+
+// Called with the address of the interrupted instruction.
+typedef void (*IrqIsr)(uvalptr pc);
+
+typedef struct type_IRQ_STAT IrqStat;
+
+// Time from a line being raised to its handler starting, in ReadClock() 
+// units. Only measured when whoever raised the line stored the time in 
+// IrqRaisedAt[], as the simulation in irqsim.c does.
+struct type_IRQ_STAT
+{
+  uval32 count;
+  uval32 total;
+  uval32 max;
+};
+
+// Kept by interrupt_handler() in exception.c. Clearing IrqNest makes 
+// every handler run with interrupts off, for comparison.
+extern IrqStat IrqStats[NUM_IRQS];
+extern volatile uval32 IrqRaisedAt[NUM_IRQS];
+extern bool IrqNest;
+
+void InitIo(void);
+void InitIoMock(volatile uval32 *timer, volatile uval32 *pushbutton, volatile uval8 *lcd);
+void EnableIrq(int irq);
+uval32 IrqPending(void);
+void IrqAck(int irq);
+uval32 IrqSetMask(uval32 enabled);
+bool IrqLock(void);
+void IrqUnlock(bool enabled);
+void RequestIrq(int irq, int priority, IrqIsr isr);
+
+#ifndef NATIVE
+// Signals standing in for the interrupt lines on x86.
+#define IRQ_SIGNAL(irq) (SIGRTMIN + (irq))
+
+void RaiseIrq(int irq);
+#endif /* NATIVE */
+
+#endif
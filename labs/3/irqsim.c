@@ -0,0 +1,154 @@
+#include "defines.h"
+#include "main.h"
+#include "io.h"
+#include "clock.h"
+#include "irqsim.h"
+
+#ifndef NATIVE
+
+#include <stdio.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// Shared with the device process. raised[irq] is the ReadClock() time 
+// the line was asserted, or 0 once its handler has started.
+typedef struct type_SIM_DEVICES SimDevices;
+
+struct type_SIM_DEVICES
+{
+  volatile uval32 raised[NUM_IRQS];
+};
+
+static SimDevices *Devices;
+static uval32 SlowSpin;
+
+static void SlowIsr(uvalptr pc)
+{
+  uval32 start = ReadClock();
+
+  while (ReadClock() - start < SlowSpin);
+}
+
+// Plays the_isr: the line's signal arrives with the interrupt signals 
+// blocked, as the processor clears status.PIE.
+static void SimSignal(int sig)
+{
+  int irq = sig - IRQ_SIGNAL(0);
+  bool enabled = IrqLock();
+
+  if (irq == TIMER_IRQ) {
+    TIMER_STATUS = TIMER_TO;
+  }
+  IrqRaisedAt[irq] = Devices->raised[irq];
+  Devices->raised[irq] = 0;
+  RaiseIrq(irq);
+
+  interrupt_handler(0);
+  IrqUnlock(enabled);
+}
+
+// The device process: asserts each line on its period, unless it is 
+// still waiting to be served.
+static void SimDevice(pid_t kernel)
+{
+  int irqs[2] = { TIMER_IRQ, SIM_SLOW_IRQ };
+  uval32 period[2] = { CLOCK_HZ / SIM_TIMER_HZ, CLOCK_HZ / SIM_SLOW_HZ };
+  uval32 next[2];
+  uval32 end, now;
+  struct timespec nap = { 0, 20000 };
+  int i;
+
+  now = ReadClock();
+  end = now + SIM_SECONDS * CLOCK_HZ;
+  for (i = 0; i < 2; i++) {
+    next[i] = now + period[i];
+  }
+
+  while ((int) (end - (now = ReadClock())) > 0) {
+    for (i = 0; i < 2; i++) {
+      if ((int) (now - next[i]) < 0) {
+	continue;
+      }
+      next[i] += period[i];
+      if (!Devices->raised[irqs[i]]) {
+	Devices->raised[irqs[i]] = now ? now : 1;
+	kill(kernel, IRQ_SIGNAL(irqs[i]));
+      }
+    }
+    nanosleep(&nap, NULL);
+  }
+  _exit(0);
+}
+
+static void SimReport(char *mode)
+{
+  int irqs[2] = { TIMER_IRQ, SIM_SLOW_IRQ };
+  IrqStat *stat;
+  int i;
+
+  printf("%s:\n  irq    count    mean us     max us\n", mode);
+  for (i = 0; i < 2; i++) {
+    stat = &IrqStats[irqs[i]];
+    printf("  %3d %8u %10.1f %10.1f\n", irqs[i], stat->count,
+	   stat->count ? 1e6 * stat->total / stat->count / CLOCK_HZ : 0.0,
+	   1e6 * stat->max / CLOCK_HZ);
+  }
+}
+
+static void SimRun(bool nest)
+{
+  pid_t device;
+  int i;
+
+  for (i = 0; i < NUM_IRQS; i++) {
+    IrqStats[i].count = IrqStats[i].total = IrqStats[i].max = 0;
+    Devices->raised[i] = 0;
+  }
+  IrqNest = nest;
+
+  device = fork();
+  if (device == 0) {
+    SimDevice(getppid());
+  }
+  while (waitpid(device, NULL, 0) != device);
+
+  SimReport(nest ? "nested" : "not nested");
+}
+
+// Runs the harness on an initialized kernel. slowUs is how long the slow
+// device's handler takes.
+int IrqSim(uval32 slowUs)
+{
+  struct sigaction action;
+  int irqs[2] = { TIMER_IRQ, SIM_SLOW_IRQ };
+  int i;
+
+  Devices = mmap(NULL, sizeof(SimDevices), PROT_READ | PROT_WRITE,
+		 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (Devices == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  SlowSpin = slowUs * (CLOCK_HZ / 1000000);
+
+  action.sa_handler = SimSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  for (i = 0; i < 2; i++) {
+    sigaddset(&action.sa_mask, IRQ_SIGNAL(irqs[i]));
+  }
+  for (i = 0; i < 2; i++) {
+    sigaction(IRQ_SIGNAL(irqs[i]), &action, NULL);
+  }
+  RequestIrq(SIM_SLOW_IRQ, SIM_SLOW_IRQ_PRIORITY, SlowIsr);
+
+  SimRun(TRUE);
+  SimRun(FALSE);
+  IrqNest = TRUE;
+  return 0;
+}
+
+#endif /* NATIVE */
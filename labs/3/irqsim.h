@@ -0,0 +1,24 @@
+#ifndef _IRQSIM_H_
+#define _IRQSIM_H_
+
+#include "defines.h"
+
+// Interrupt latency harness, x86 build only. With KIRQSIM=<us> in the 
+// environment prog raises the timer line at SIM_TIMER_HZ and a slow 
+// device line, whose handler spins for <us> microseconds, at SIM_SLOW_HZ,
+// from a second process through signals. It reports the latency of each
+// line with nested interrupts and with every handler run to completion.
+#define IRQSIM_ENV "KIRQSIM"
+
+#define SIM_SLOW_IRQ          2
+#define SIM_SLOW_IRQ_PRIORITY 2
+
+#define SIM_SECONDS  2
+#define SIM_TIMER_HZ 1000
+#define SIM_SLOW_HZ  170
+
+#ifndef NATIVE
+int IrqSim(uval32 slowUs);
+#endif /* NATIVE */
+
+#endif
@@ -2,14 +2,33 @@
 #include "list.h"
 #include "kernel.h"
 #include "main.h"
+#include "io.h"
+#include "button.h"
+#include "lcd.h"
+#include "clock.h"
+#include "edf.h"
+#include "fair.h"
+#include "pool.h"
+#include "ltask.h"
+#include "waitq.h"
+#include "latency.h"
+#include "prof.h"
+#include "kinfo.h"
+#include "trace.h"
+#include "sched.h"
+#include "sync.h"
+#include "rwlock.h"
+#include "timer.h"
+#include "waitset.h"
+#include "heap.h"
+#include "klog.h"
+#include "cluster.h"
+#include "group.h"
 
 #include <stdlib.h>
 #include <assert.h>
 
 
-// Fixed size array of TDs
-TD TD_ARRAY[MAX_THREADS];
-// 
 
 // Contains the actively running thread
 TD *Active;
@@ -17,6 +36,7 @@ TD *Active;
 // status register, and program counter of system 
 // call handler. Used to enter/exit to/from system calls.
 TD Kernel;
+TDCold KernelCold;
 
 Stack KernelStack;
 
@@ -26,15 +46,16 @@ Stack KernelStack;
 // equal priority. 
 LL* ReadyQ;
 
-// Contains the TDs of all threads currently blocked. See Suspend()
-LL* BlockedQ;
-
 // Contains all TDs that are currently unallocated. You have an array of 
 // thread descriptors, and not all of them  will always be used. Any descriptor 
 // that is not used should be placed into this queue, so that they are easily 
 // accessible when a new descriptor is needed.
 LL* FreeQ;
 
+// Set when a thread that should run ahead of Active became ready while 
+// the kernel could not switch to it, e.g. in an interrupt handler.
+bool NeedResched;
+
 void InitKernel(void) {
 
 	int i;
@@ -44,26 +65,52 @@ void InitKernel(void) {
 	InitTD(Active, 0, 0, 1); //Will be set with proper return registers on context switch
 	*/
 
+	// Everything below allocates from the kernel heap.
+	InitHeap();
+
 	// Initialize kernel's sp, sr and pc of syscall handler.
+	Kernel.cold = &KernelCold;
 #ifdef NATIVE
-	InitTD(&Kernel, (uval32) SysCallHandler, (uval32) &(KernelStack.stack[STACKSIZE]), 0);
-	Kernel.regs.sr = DEFAULT_KERNEL_SR;
+	InitTD(&Kernel, (uval32) K_SysCall, (uval32) &(KernelStack.stack[STACKSIZE]), 0);
+	Kernel.cold->regs.sr = DEFAULT_KERNEL_SR;
 #endif /* NATIVE */
 
-	// Initialize lists
+	// Initialize lists. ReadyQ marks the priority class threads the 
+	// scheduling policy holds, and is the queue of the list policy.
 	ReadyQ = CreateList(L_PRIORITY);
+	if (!Sched) {
+		SchedSelect(SCHED_DEFAULT);
+	}
+	Sched->init();
 
-	BlockedQ = CreateList(UNDEF);
+	// Threads blocked in the kernel, including by Suspend()
+	InitWaitq();
 
 	FreeQ = CreateList(L_CIRCULAR);
 
+	// Initialize device drivers
+	InitIo();
+	InitButtons();
+	InitLcd();
+
+	// Initialize scheduling classes and the tick that drives them
+	InitEdf();
+	InitFair();
+	InitClock();
+
+	InitPools();
+	InitSync();
+	InitTimers();
+	InitCluster();
+	InitGroups();
+
 	// Initialize ReadyQ with idle thread that has lowest priority
-	TD* idle_td = CreateTD(1);
+	TD* idle_td = CreateTD(IDLE_TID);
 	InitTD(idle_td, (uval32) Idle, (uval32) &(KernelStack.stack[STACKSIZE]), MIN_PRIORITY);
-	PriorityEnqueue(idle_td, ReadyQ);
+	MakeReady(idle_td);
 
-	// Initialize FreeQ
-	for(i=0;i<NUM_TID;i++){
+	// Initialize FreeQ with every other tid
+	for(i=IDLE_TID;i<NUM_TID;i++){
 		TD* free_td;
 		// No thread should have a TID of 0.
 		free_td = CreateTD(i+1);
@@ -72,6 +119,9 @@ void InitKernel(void) {
 		FreeQEnqueue(free_td, FreeQ);
 	}
 
+	// Needs a thread of its own, so comes after the FreeQ
+	InitLTasks();
+
 /*
 	int tid_cnt = NUM_TID;
 	while (tid_cnt > 0) {
@@ -81,8 +131,8 @@ void InitKernel(void) {
 		tid_cnt--;
 	}
 */
-	// Initialize Active to the idle thread, i.e. yield
-	Yield();
+	// Initialize Active to the idle thread
+	Dispatch();
 
 
 	/*
@@ -102,14 +152,14 @@ void InitKernel(void) {
 	- Save current context
 	- Restore context of next active.
 */
-void K_SysCall(SysCallType type, uval32 arg0, uval32 arg1, uval32 arg2) {
-#ifdef NATIVE
-	asm(".align 4; .global SysCallHandler; SysCallHandler:");
-	uval32 sysMode = SYS_EXIT;
-#endif
+sval32 K_SysCall(SysCallType type, uvalptr arg0, uvalptr arg1, uvalptr arg2) {
+	// Active may change below; the result belongs to the caller.
+	TD *caller = Active;
+	sval32 returnCode;
 
-	RC returnCode;
-	//T_RC err;
+	SYS_STAMP(sysEnter);
+	KInfoPage.syscalls++;
+	TRACE_SYSCALL(type, arg0, arg1, arg2);
 
 	switch (type) {
 	case SYS_CREATE:
@@ -130,18 +180,164 @@ void K_SysCall(SysCallType type, uval32 arg0, uval32 arg1, uval32 arg2) {
 	case SYS_CHANGE_PRI:
 		returnCode = ChangeThreadPriority(arg0, arg1);
 		break;
+	case SYS_BUTTON_WAIT:
+		returnCode = ButtonWait((uval32 *) arg0);
+		break;
+	case SYS_LCD_POST:
+		returnCode = LcdPost((LcdMsg *) arg0);
+		break;
+	case SYS_LCD_WAIT:
+		returnCode = LcdWait((LcdMsg *) arg0);
+		break;
+	case SYS_CREATE_EDF:
+		returnCode = CreateEdfThread(arg0, (EdfParams *) arg1);
+		break;
+	case SYS_EDF_NEXT:
+		returnCode = EdfNextPeriod();
+		break;
+	case SYS_CREATE_FAIR:
+		returnCode = CreateFairThread(arg0, arg1);
+		break;
+	case SYS_POOL_CREATE:
+		returnCode = PoolCreate(arg0, arg1, (int *) arg2);
+		break;
+	case SYS_POOL_SUBMIT:
+		returnCode = PoolSubmit(arg0, (TaskFn) arg1, (void *) arg2);
+		break;
+	case SYS_POOL_WAIT:
+		returnCode = PoolWait((Task *) arg0);
+		break;
+	case SYS_LTASK_CREATE:
+		returnCode = LTaskCreate((LTaskSpec *) arg0, (uval32 *) arg1);
+		break;
+	case SYS_LTASK_SIGNAL:
+		returnCode = LTaskSignal(arg0);
+		break;
+	case SYS_LTASK_NEXT:
+		returnCode = LTaskNext(arg0, (LTask **) arg1);
+		break;
+	case SYS_WAIT:
+		returnCode = WaitSys(arg0);
+		break;
+	case SYS_WAKE:
+		returnCode = WakeSys(arg0, arg1, (int *) arg2);
+		break;
+	case SYS_LAT_DUMP:
+		returnCode = LatDump(arg0);
+		break;
+	case SYS_PROF:
+		returnCode = ProfControl(arg0);
+		break;
+	case SYS_KINFO:
+		returnCode = KInfoQuery(arg0, (uval32 *) arg1);
+		break;
+	case SYS_BARRIER_CREATE:
+		returnCode = BarrierCreate(arg0, (int *) arg1);
+		break;
+	case SYS_BARRIER_WAIT:
+		returnCode = BarrierWait(arg0);
+		break;
+	case SYS_BARRIER_DESTROY:
+		returnCode = BarrierDestroy(arg0);
+		break;
+	case SYS_LATCH_CREATE:
+		returnCode = LatchCreate(arg0, (int *) arg1);
+		break;
+	case SYS_LATCH_COUNT_DOWN:
+		returnCode = LatchCountDown(arg0);
+		break;
+	case SYS_LATCH_WAIT:
+		returnCode = LatchWait(arg0);
+		break;
+	case SYS_LATCH_DESTROY:
+		returnCode = LatchDestroy(arg0);
+		break;
+	case SYS_RW_READ:
+		returnCode = RwRead((RwLock *) arg0);
+		break;
+	case SYS_RW_WRITE:
+		returnCode = RwWrite((RwLock *) arg0);
+		break;
+	case SYS_RW_UNLOCK:
+		returnCode = RwUnlock((RwLock *) arg0);
+		break;
+	case SYS_TIMER_CREATE:
+		returnCode = TimerCreate((TimerSpec *) arg0, (int *) arg1);
+		break;
+	case SYS_TIMER_CANCEL:
+		returnCode = TimerCancel(arg0);
+		break;
+	case SYS_TIMER_WAIT:
+		returnCode = TimerWait(arg0);
+		break;
+	case SYS_TIMER_NEXT:
+		returnCode = TimerNext((Task *) arg0);
+		break;
+	case SYS_SEM_CREATE:
+		returnCode = SemCreate(arg0, (int *) arg1);
+		break;
+	case SYS_SEM_POST:
+		returnCode = SemPost(arg0);
+		break;
+	case SYS_SEM_WAIT:
+		returnCode = SemWait(arg0);
+		break;
+	case SYS_SEM_DESTROY:
+		returnCode = SemDestroy(arg0);
+		break;
+	case SYS_WAIT_ANY:
+		returnCode = WaitAny((WaitSet *) arg0);
+		break;
+	case SYS_HEAP_ALLOC:
+		returnCode = HeapAllocSys(arg0, (void **) arg1);
+		break;
+	case SYS_HEAP_FREE:
+		returnCode = HeapFreeSys((void *) arg0);
+		break;
+	case SYS_HEAP_STATS:
+		returnCode = HeapStatsSys((HeapStats *) arg0);
+		break;
+	case SYS_KLOG_DUMP:
+		returnCode = KLogDump(arg0);
+		break;
+	case SYS_MSG_SEND:
+		returnCode = MsgSend((ClusterMsg *) arg0, (bool *) arg1);
+		break;
+	case SYS_MSG_RECV:
+		returnCode = MsgRecv((ClusterMsg *) arg0);
+		break;
+	case SYS_GROUP_CREATE:
+		returnCode = GroupCreate((int *) arg0);
+		break;
+	case SYS_CREATE_GROUPED:
+		returnCode = GroupCreateThread(arg2, arg0, arg1);
+		break;
+	case SYS_GROUP_CTL:
+		returnCode = GroupControl(arg0, (GroupOp) arg1, arg2);
+		break;
 	default:
-		myprint("Invalid SysCall type\n");
+		KLOG_WARN(KLOG_BAD_SYSCALL, type, 0, 0);
 		returnCode = FAILED;
 		break;
 	}
+
+	// A thread woken by an interrupt while we were in the kernel
+	if (NeedResched) {
+		Preempt();
+	}
+
+	// The caller gets the result in r2 whenever it next runs: the_isr 
+	// restores it from the caller's frame. Nothing to do if the call 
+	// destroyed the caller.
+	if (caller->inlist != FreeQ) {
+		caller->cold->returnCode = returnCode;
 #ifdef NATIVE
-	// Once kernel has decided who to run next, 
-	// we store SYS_EXIT as our sysmode and return 
-	// to interrupt handler.
-	asm volatile("ldw r8, %0" : : "m" (sysMode): "r8");
-	asm( "trap" );
+		*(sval32 *) (uvalptr) (caller->cold->regs.sp + FRAME_R2_OFFSET) = returnCode;
 #endif /* NATIVE */
+	}
+
+	SYS_STAMP(sysExit);
+	return returnCode;
 }
 /*
  * Gets a tid from FreeQ and returns it.
@@ -163,77 +359,32 @@ uval32 getTid(){
 	return FreeQDequeue(FreeQ);
 }
 
+// A tid is in use from the time CreateThread() takes it off the FreeQ
+// until DestroyThread() puts it back.
+int tidInUse(ThreadId tid) {
+	if ((tid > NUM_TID) || (tid < 1)) {
+		return 0;
+	}
+	return TD_TABLE[tid].inlist != FreeQ;
+}
+
 /*
  * Given a tid, returns the associated TD struct.
- * Returns NULL if is not found in ReadyQ or BlockedQ.
+ * Returns NULL if tid is not in use.
  *
  */
 
 TD * getTD(ThreadId tid) {
 
-	TD * ptr = ReadyQ->head;
-
-	while (ptr != NULL) {
-		if (ptr->tid == tid) {
-			return ptr;
-		} else {
-			ptr = ptr->link;
-		}
-	}
-
-	ptr = BlockedQ->head;
-
-	while (ptr != NULL) {
-			if (ptr->tid == tid) {
-				return ptr;
-			} else {
-				ptr = ptr->link;
-			}
-		}
-	return NULL;
-}
-
-/*
-int tidInUse(ThreadId tid) {
-	if ((tid > NUM_TID) || (tid < 1)) {
-		return 0;
-	} else {
-		TD *ptr = FreeQ->head;
-		while (ptr != NULL) {
-			if (ptr->priority == tid) {
-				return 1;
-			} else {
-				ptr = ptr->link;
-			}
-		}
-		return 0;
-	}
-}*/
-
-int tidInUse(ThreadId tid) {
-	if ((tid > NUM_TID) || (tid < 1)) {
-		return 0;
-	} else {
-		TD *ptr = FreeQ->head;
-		if (ptr->priority == tid) { // Case: checks head for tid
-			return 1;
-		} else {
-			ptr = ptr->link;
-		}
-		while (ptr != FreeQ->head) { // Case: checks the rest of the list
-			if (ptr->priority == tid) {
-				return 1;
-			} else {
-				ptr = ptr->link;
-			}
-		}
-		return 0;
+	if (!tidInUse(tid)) {
+		return NULL;
 	}
+	return &TD_TABLE[tid];
 }
 
 /* 	Creates a new thread that should start executing the procedure pointed to by
  *	pc. Creating a new thread should be done by first allocating a stack at the
- *	user level (using malloc() with a minimum size of 8K). At the kernel level,
+ *	user level (from the kernel heap, with a minimum size of 8K). At the kernel level,
  *	this should cause a new thread descriptor to be allocated, its fields to be
  *	initialized and the descriptor to be enqueued in the ReadyQ. If the new
  *	thread has higher priority than the invoking thread then the invoking thread
@@ -245,37 +396,58 @@ int tidInUse(ThreadId tid) {
  *	in the range of valid priorities.
  */
 
-T_RC CreateThread(uval32 pc, uval32 sp, uval32 priority) {
-	int *ptr, tid;
+sval32 CreateThread(uval32 pc, uval32 stackSize, uval32 priority) {
 	TD *thread;
-	//RC sysReturn = RC_SUCCESS;
+	T_RC rc;
 
-	if ((priority < 1) & (priority > 128)) {
+	if ((priority < 1) || (priority > MIN_PRIORITY)) {
 		return PRIORITY_ERROR;
-	} else if (!(tid = getTid())) {
-		return RESOURCE_ERROR;
-	} else if ((ptr = malloc(8192)) == 0) {
+	} else if (stackSize < STACKSIZE) {
+		// Every thread gets a STACKSIZE stack; asking for less is an error.
 		return STACK_ERROR;
+	} else if ((rc = AllocThread(pc, priority, &thread)) != OK) {
+		return rc;
 	}
-	//Stack user_stack;
-	// Create a new thread descriptor to be allocated
-	thread = CreateTD(tid);
+	MakeReady(thread);
 
-    thread->priority = priority;
-    thread->inlist = ReadyQ;
-    thread->regs.pc = pc;
-    thread->regs.sp = sp;
+	KLOG_DEBUG(KLOG_CREATE_THREAD, thread->tid, priority, 0);
 
-	myprint("CreateThread ");
-
-	if (priority > Active->priority) {
+	if (RunsBefore(thread, Active)) {
     	Yield();
     }
 
-    // How can we make ThreadId a "subtype" of T_RC?
-	//return tid;
+	// Errors are negative, so the tid can share the result.
+	return thread->tid;
+}
 
-	// Return OK for now
+// Allocates a TD and a stack for a new thread that starts at pc. The 
+// thread is not put on any list.
+T_RC AllocThread(uval32 pc, uval32 priority, TD **td) {
+	uval8 *ptr;
+	uval32 sp;
+	int tid;
+	TD *thread;
+
+	if (!(tid = getTid())) {
+		return RESOURCE_ERROR;
+	} else if ((ptr = HeapAlloc(STACKSIZE)) == 0) {
+		// Give the tid back, as ReleaseThread() does.
+		FreeQEnqueue(CreateTD(tid), FreeQ);
+		return STACK_ERROR;
+	}
+	//Stack user_stack;
+	// Create a new thread descriptor to be allocated
+	thread = CreateTD(tid);
+
+	// Leave room at the top of the stack for the frame the_isr restores
+	// on the way out of the kernel (LOAD_REGS also reads 116(sp)), and 
+	// make it return to pc.
+	sp = (uval32) (uvalptr) (ptr + STACKSIZE - FRAME_SIZE - sizeof(uval32));
+	*(uval32 *) (ptr + STACKSIZE - FRAME_SIZE - sizeof(uval32) + FRAME_EA_OFFSET) = pc;
+	InitTD(thread, pc, sp, priority);
+	thread->cold->stack = ptr;
+
+	*td = thread;
 	return OK;
 }
 
@@ -298,13 +470,14 @@ T_RC ResumeThread(ThreadId tid) {
 	} else if ((td = getTD(tid)) == NULL) {
 		return TID_ERROR;
 	} else {
-		if (td->inlist != BlockedQ) {
+		// Suspended threads wait on their own TD.
+		if (!WaitingOn(td, td)) {
 			return NOT_BLOCKED;
-		} else {
-			td->inlist = ReadyQ;
 		}
 
-		if (td->priority > Active->priority) {
+		WaitqRemove(td);
+		MakeReady(td);
+		if (RunsBefore(td, Active)) {
 			Yield();
 		}
 		return OK;
@@ -333,17 +506,25 @@ T_RC ChangeThreadPriority(ThreadId tid, int newPriority) {
 		td = getTD(tid);
 	}
 
-	if ((newPriority < 1) & (newPriority > 128)) {
+	if ((newPriority < 1) || (newPriority > MIN_PRIORITY)) {
 		return PRIORITY_ERROR;
 	}
 
-	td->priority = newPriority;
+	// EDF and fair threads get their place from their class.
+	if (td->sched != SCHED_PRIORITY) {
+		return PRIORITY_ERROR;
+	}
+
+	if (td == Active) {
+		KInfoPage.priority = newPriority;
+	}
 
 	if (td->inlist == ReadyQ){
-		if (Dequeue(td, ReadyQ)) {
-			PriorityEnqueue(td, ReadyQ);
-		} else {
-			myprint("Dequeue error\n");
+		Sched->requeue(td, newPriority);
+	} else {
+		td->priority = newPriority;
+		if (td->inlist == WaitQ) {
+			WaitqRequeue(td);
 		}
 	}
 
@@ -359,34 +540,58 @@ T_RC DestroyThread(ThreadId tid) {
 	// dispatched.
 	if (tid == 0 || tid == Active->tid) {
 		// Kill the Active Thread
-		Active = NULL;
-		// Dispatch the head of the ReadyQ.
+		td_tid = Active;
+		// Dispatch the next thread.
 		// We know that there is at least one thread here
 		// (the idle thread).
 		// But what happens if the idle thread is destroyed?
 		// Can this happen? Should we replace it if so?
-		Active = DequeueHead(ReadyQ);
-	}
-
-	// Remove the thread descriptor from whatever queue it is in.
+		Dispatch();
+	} else {
+		// Remove the thread descriptor from whatever queue it is in.
 
-	// First find the TD associated with tid by searching in the
-	// three lists.
-	if ((td_tid = FindTD(tid, ReadyQ)) == NULL) {
-		if ((td_tid = FindTD(tid, BlockedQ)) == NULL) {
+		// First find the TD associated with tid by searching in the
+		// lists.
+		if ((td_tid = getTD(tid)) == NULL) {
 			return TID_ERROR;
 		}
+
+		// Then dequeue the TD from the list it is in.
+		Unqueue(td_tid);
 	}
 
-	// Then dequeue the TD from the list it is in.
-	DequeueTD(td_tid);
+	ReleaseThread(td_tid);
+	return OK;
 
-	// Add TD identified by tid to the list of free descriptors
-	td_tid = CreateTD(tid);
-	EnqueueAtHead(td_tid, FreeQ);
+}
 
-	return OK;
+// Takes td, which is not Active, off whatever queue it is in.
+void Unqueue(TD *td) {
 
+	if (td->inlist == ReadyQ) {
+		Sched->remove(td);
+	} else if (td->inlist == FairQ) {
+		FairRemove(td);
+	} else if (td->inlist == WaitQ) {
+		WaitqRemove(td);
+	} else {
+		DequeueTD(td);
+	}
+}
+
+// Frees everything held by td, which is on no queue, and returns its tid
+// to the FreeQ.
+void ReleaseThread(TD *td) {
+	ThreadId tid = td->tid;
+
+	GroupExit(td);
+	EdfExit(td);
+	ClusterExit(td);
+	HeapFree(td->cold->stack);
+
+	// Add TD identified by tid to the list of free descriptors
+	td = CreateTD(tid);
+	FreeQEnqueue(td, FreeQ);
 }
 
 // Allows the invoking thread to yield the processor to the highest 
@@ -395,9 +600,9 @@ T_RC Yield() {
 
 	// Enqueue the Active thread onto the ReadyQ behind all threads of
 	// the same, or higher, priority.
-	PriorityEnqueue(Active, ReadyQ);
+	MakeReady(Active);
 	// Dispatch the ready-to-run thread with the highest priority
-	Active = DequeueHead(ReadyQ);
+	Dispatch();
 
 	return OK;
 }
@@ -405,12 +610,85 @@ T_RC Yield() {
 // Block the invoking thread until it is woken up again.
 T_RC Suspend() {
 
-	// Enqueue the Active thread onto BlockedQ
-	EnqueueAtHead(Active, BlockedQ);
-	// Dispatch the ready-to-run thread with the highest priority
-	Active = DequeueHead(ReadyQ);
+	// Wait on our own TD, which is where ResumeThread() looks, and 
+	// dispatch the ready-to-run thread with the highest priority
+	return WaitOn(Active);
+}
 
-	return OK;
+// Puts td, which is on no list, into the ready queue of its class.
+void MakeReady(TD *td) {
+
+	LAT_READY(td);
+	if (td->sched == SCHED_EDF) {
+		DeadlineEnqueue(td, EdfQ);
+	} else if (td->sched == SCHED_FAIR) {
+		FairEnqueue(td);
+	} else {
+		Sched->enqueue(td);
+	}
+}
+
+// Makes td, which is no longer on any list, ready to run. Safe to call
+// from interrupt handlers: if td should run ahead of Active, the switch 
+// happens on the way out of the interrupt or system call.
+void WakeThread(TD *td) {
+
+	MakeReady(td);
+	if (RunsBefore(td, Active)) {
+		NeedResched = TRUE;
+	}
+}
+
+// Whether td should get the processor ahead of other. EDF threads run 
+// ahead of all others and among themselves by deadline; fair threads 
+// compete by priority as a band and among themselves by vruntime.
+bool RunsBefore(TD *td, TD *other) {
+
+	if (td->sched == SCHED_EDF && other->sched == SCHED_EDF) {
+		return td->deadline < other->deadline;
+	} else if (td->sched == SCHED_FAIR && other->sched == SCHED_FAIR) {
+		return FairBefore(td, other);
+	}
+	return td->priority < other->priority;
+}
+
+// Makes the most urgent ready thread Active: EDF threads first, then the 
+// priority class down to FAIR_PRIORITY, then the fair threads, then the 
+// rest of the priority class, which always holds at least the idle 
+// thread.
+void Dispatch(void) {
+	TD *prev = Active;
+
+	if (EdfQ->head) {
+		Active = DequeueHead(EdfQ);
+	} else if (FairPeek() && Sched->peek()->priority > FAIR_PRIORITY) {
+		Active = FairDequeueMin();
+	} else {
+		Active = Sched->dequeue();
+	}
+	Active->inlist = NULL;
+	LAT_DISPATCH(Active);
+	NeedResched = FALSE;
+
+	// Logged here rather than by Idle() itself, which runs in user mode 
+	// and yields on every pass: once when the CPU goes idle.
+	if (Active->tid == IDLE_TID && (!prev || prev->tid != IDLE_TID)) {
+		KLOG_DEBUG(KLOG_IDLE, 0, 0, 0);
+	}
+
+	KInfoPage.tid = Active->tid;
+	KInfoPage.priority = Active->priority;
+	KInfoPage.switches++;
+}
+
+// Takes the processor away from Active on the way out of an interrupt 
+// or system call. Active may already be on a list if it was throttled.
+void Preempt(void) {
+
+	if (Active->inlist == NULL) {
+		MakeReady(Active);
+	}
+	Dispatch();
 }
 
 void Idle() {
@@ -418,7 +696,6 @@ void Idle() {
 	 int i;
 	 while( 1 )
 	 {
-	 	myprint( "CPU is idle\n" );
 	 	for( i = 0; i < MAX_THREADS; i++ )
 	 	{
 	 	}
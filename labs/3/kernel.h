@@ -11,26 +11,37 @@ struct type_STACK
   uval8 stack[STACKSIZE]; 
 };
 
-//extern TD TD_ARRAY[128];
+// The idle thread always has this tid.
+#define IDLE_TID 1
 
 extern TD* Active;
 extern TD Kernel;
 
 extern LL* ReadyQ;
-extern LL* BlockedQ; 
 extern LL* FreeQ;
 
-ThreadId CreateThread( uval32 pc, uval32 stackSize, uval32 priority );
+extern bool NeedResched;
+
+sval32 CreateThread( uval32 pc, uval32 stackSize, uval32 priority );
+T_RC AllocThread( uval32 pc, uval32 priority, TD **td );
 T_RC DestroyThread( ThreadId tid );
+void Unqueue(TD *td);
+void ReleaseThread(TD *td);
 T_RC ResumeThread( ThreadId tid );
 T_RC ChangeThreadPriority(ThreadId tid, int newPriority);
 T_RC Yield();
 T_RC Suspend();
+void WakeThread(TD *td);
+void MakeReady(TD *td);
+void Dispatch(void);
+void Preempt(void);
+bool RunsBefore(TD *td, TD *other);
+int tidInUse(ThreadId tid);
+TD *getTD(ThreadId tid);
 
 
 void Idle(void);
 void InitKernel(void);  
 
-void K_SysCall( SysCallType type, uval32 arg0, uval32 arg1, uval32 arg2);
-extern void SysCallHandler(SysCallType type, uval32 arg0, uval32 arg1, uval32 arg2);
+sval32 K_SysCall( SysCallType type, uvalptr arg0, uvalptr arg1, uvalptr arg2);
 #endif
@@ -0,0 +1,27 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "kinfo.h"
+
+// One cache line, so a query costs at most one miss.
+KInfo KInfoPage __attribute__ ((aligned (32)));
+
+const KInfo * const KernelInfo = &KInfoPage;
+
+// SYS_KINFO: the same queries through a trap. Kept for comparison with 
+// the shared page, see KInfoBench().
+T_RC KInfoQuery(KInfoField field, uval32 *value)
+{
+  switch (field) {
+  case KINFO_TID:
+    *value = Active->tid;
+    return OK;
+  case KINFO_TICKS:
+    *value = KInfoPage.ticks;
+    return OK;
+  case KINFO_PRIORITY:
+    *value = Active->priority;
+    return OK;
+  }
+  return FAILED;
+}
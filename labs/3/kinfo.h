@@ -0,0 +1,43 @@
+#ifndef _KINFO_H_
+#define _KINFO_H_
+
+#include "defines.h"
+
+// Kernel data page. The kernel keeps it up to date on every dispatch, 
+// tick and system call, so threads can answer the common "who am I, 
+// what time is it" questions with a load instead of a trap. There is 
+// no MMU to protect it; threads only get a const view.
+typedef struct type_KINFO KInfo;
+
+struct type_KINFO
+{
+  volatile ThreadId tid;	// Active thread
+  volatile uval32 priority;	// and its priority
+  volatile uval32 ticks;	// same as Ticks
+  volatile uval32 switches;	// dispatches since boot
+  volatile uval32 syscalls;	// system calls since boot
+  volatile uval32 sysEnter;	// ReadClock() on entering and leaving
+  volatile uval32 sysExit;	// K_SysCall(), see SYS_STAMP()
+};
+
+typedef enum { KINFO_TID, KINFO_TICKS, KINFO_PRIORITY } KInfoField;
+
+extern KInfo KInfoPage;
+extern const KInfo * const KernelInfo;
+
+// Trap-free queries for threads.
+#define GetTid()      (KernelInfo->tid)
+#define GetTicks()    (KernelInfo->ticks)
+#define GetPriority() (KernelInfo->priority)
+
+// Build with -DSYSCALL_TIMING to have K_SysCall() stamp the page, so 
+// KInfoBench() can split the cost of a trap into entry and exit.
+#ifdef SYSCALL_TIMING
+#define SYS_STAMP(field) (KInfoPage.field = ReadClock())
+#else /* SYSCALL_TIMING */
+#define SYS_STAMP(field)
+#endif /* SYSCALL_TIMING */
+
+T_RC KInfoQuery(KInfoField field, uval32 *value);
+
+#endif
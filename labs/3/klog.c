@@ -0,0 +1,63 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "main.h"
+#include "clock.h"
+#include "klog.h"
+
+static KLogRec Ring[KLOG_SIZE];
+// Records logged since the last reset; the next goes in 
+// Ring[Logged % KLOG_SIZE].
+static uval32 Logged;
+
+void KLog(uval8 level, KLogId id, uval32 a0, uval32 a1, uval32 a2)
+{
+  KLogRec *rec = &Ring[Logged++ & (KLOG_SIZE - 1)];
+
+  rec->tick = Ticks;
+  rec->tid = Active ? Active->tid : 0;
+  rec->id = id;
+  rec->level = level;
+  rec->arg[0] = a0;
+  rec->arg[1] = a1;
+  rec->arg[2] = a2;
+}
+
+// SYS_KLOG_DUMP: prints the records still in the ring, oldest first, in
+// the format klogview reads: a "K" line with how many were logged in all,
+// then "L tick tid level id arg0 arg1 arg2" per record. Empties the ring 
+// if reset is set.
+T_RC KLogDump(bool reset)
+{
+  uval32 i, first;
+  KLogRec *rec;
+
+  first = Logged > KLOG_SIZE ? Logged - KLOG_SIZE : 0;
+
+  myprint("K ");
+  printHex(Logged);
+  myprint("\n");
+  for (i = first; i != Logged; i++) {
+    rec = &Ring[i & (KLOG_SIZE - 1)];
+    myprint("L ");
+    printHex(rec->tick);
+    myprint(" ");
+    printHex(rec->tid);
+    myprint(" ");
+    printHex(rec->level);
+    myprint(" ");
+    printHex(rec->id);
+    myprint(" ");
+    printHex(rec->arg[0]);
+    myprint(" ");
+    printHex(rec->arg[1]);
+    myprint(" ");
+    printHex(rec->arg[2]);
+    myprint("\n");
+  }
+
+  if (reset) {
+    Logged = 0;
+  }
+  return OK;
+}
@@ -0,0 +1,68 @@
+#ifndef _KLOG_H_
+#define _KLOG_H_
+
+#include "defines.h"
+#include "klogmsg.h"
+
+// Binary kernel log. A log call stores a message id, the level, the tick,
+// the Active tid and its raw arguments in a ring of KLOG_SIZE records, 
+// overwriting the oldest; nothing is formatted or printed until 
+// SYS_KLOG_DUMP, whose output klogview decodes. There is one CPU, so one 
+// ring. Interrupt handlers log under IrqLock().
+#define KLOG_SIZE 1024
+#define KLOG_ARGS 3
+
+#define KLOG_LEVEL_DEBUG 0
+#define KLOG_LEVEL_INFO  1
+#define KLOG_LEVEL_WARN  2
+#define KLOG_LEVEL_ERROR 3
+
+// Calls below this level compile to nothing, arguments included; e.g.
+// make CFLAGS="-Wall -DKLOG_MIN_LEVEL=KLOG_LEVEL_WARN".
+#ifndef KLOG_MIN_LEVEL
+#define KLOG_MIN_LEVEL KLOG_LEVEL_DEBUG
+#endif
+
+#define KLOG_MSG(id, format) id,
+typedef enum { KLOG_MESSAGES KLOG_NUM_MESSAGES } KLogId;
+#undef KLOG_MSG
+
+typedef struct type_KLOG_REC KLogRec;
+
+struct type_KLOG_REC
+{
+  uval32 tick;
+  uval16 tid;
+  uval8 id;
+  uval8 level;
+  uval32 arg[KLOG_ARGS];
+};
+
+#if KLOG_MIN_LEVEL <= KLOG_LEVEL_DEBUG
+#define KLOG_DEBUG(id, a0, a1, a2) KLog(KLOG_LEVEL_DEBUG, id, a0, a1, a2)
+#else
+#define KLOG_DEBUG(id, a0, a1, a2)
+#endif
+
+#if KLOG_MIN_LEVEL <= KLOG_LEVEL_INFO
+#define KLOG_INFO(id, a0, a1, a2) KLog(KLOG_LEVEL_INFO, id, a0, a1, a2)
+#else
+#define KLOG_INFO(id, a0, a1, a2)
+#endif
+
+#if KLOG_MIN_LEVEL <= KLOG_LEVEL_WARN
+#define KLOG_WARN(id, a0, a1, a2) KLog(KLOG_LEVEL_WARN, id, a0, a1, a2)
+#else
+#define KLOG_WARN(id, a0, a1, a2)
+#endif
+
+#if KLOG_MIN_LEVEL <= KLOG_LEVEL_ERROR
+#define KLOG_ERROR(id, a0, a1, a2) KLog(KLOG_LEVEL_ERROR, id, a0, a1, a2)
+#else
+#define KLOG_ERROR(id, a0, a1, a2)
+#endif
+
+void KLog(uval8 level, KLogId id, uval32 a0, uval32 a1, uval32 a2);
+T_RC KLogDump(bool reset);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef _KLOGMSG_H_
+#define _KLOGMSG_H_
+
+// Messages of the kernel log. Only the id and the arguments are logged; 
+// klogview turns them back into text with the format. Formats take up to
+// KLOG_ARGS integers, with %u, %d or %x. Append new messages at the end,
+// so that the ids of old logs still decode.
+//
+// Deliberately free of other headers, so that klogview can build its 
+// table from this file alone.
+#define KLOG_MESSAGES \
+  KLOG_MSG(KLOG_CREATE_THREAD, "CreateThread tid %u priority %u") \
+  KLOG_MSG(KLOG_IDLE, "CPU is idle") \
+  KLOG_MSG(KLOG_BAD_SYSCALL, "Invalid SysCall type %u") \
+  KLOG_MSG(KLOG_NO_TD, "No thread descriptor for tid %u") \
+  KLOG_MSG(KLOG_INIT_NULL_TD, "Tried to initialize NULL pointer") \
+  KLOG_MSG(KLOG_DEQUEUE_ERROR, "Dequeue error tid %u priority %u")
+
+#endif
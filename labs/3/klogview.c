@@ -0,0 +1,51 @@
+// Host side of the kernel log. Reads the output of SYS_KLOG_DUMP on stdin
+// and prints each record as text; every other line is passed through.
+//
+//   usage: ./prog | klogview
+
+#include <stdio.h>
+
+#include "klogmsg.h"
+
+#define KLOG_MSG(id, format) format,
+static const char *Formats[] = { KLOG_MESSAGES };
+#undef KLOG_MSG
+
+#define NUM_FORMATS (sizeof(Formats) / sizeof(Formats[0]))
+
+static const char *Levels[] = { "debug", "info", "warn", "error" };
+
+int main(void)
+{
+  char line[512];
+  unsigned int tick, tid, level, id, total;
+  unsigned int arg[3];
+  unsigned long shown = 0, logged = 0;
+
+  while (fgets(line, sizeof(line), stdin)) {
+    if (sscanf(line, "K %x", &total) == 1) {
+      logged += total;
+      continue;
+    }
+    if (sscanf(line, "L %x %x %x %x %x %x %x", &tick, &tid, &level,
+	       &id, &arg[0], &arg[1], &arg[2]) != 7) {
+      fputs(line, stdout);
+      continue;
+    }
+
+    printf("%8u %4u %-5s ", tick, tid, 
+	   level < 4 ? Levels[level] : "?");
+    if (id < NUM_FORMATS) {
+      printf(Formats[id], arg[0], arg[1], arg[2]);
+    } else {
+      printf("unknown message %u: %x %x %x", id, arg[0], arg[1], arg[2]);
+    }
+    printf("\n");
+    shown++;
+  }
+
+  if (logged > shown) {
+    fprintf(stderr, "%lu older records were overwritten\n", logged - shown);
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include "defines.h"
+#include "list.h"
+#include "main.h"
+#include "latency.h"
+
+uval32 LatHist[LAT_BANDS][LAT_BUCKETS];
+
+// Values below 2^LAT_SUB_BITS get a bucket each. Above that, the bucket 
+// is the position of the top bit and the LAT_SUB_BITS bits below it.
+int LatBucket(uval32 delta)
+{
+  int msb;
+
+  if (delta < (1 << LAT_SUB_BITS)) {
+    return delta;
+  }
+
+  msb = 31 - __builtin_clz(delta);
+  return ((msb - LAT_SUB_BITS + 1) << LAT_SUB_BITS) |
+    ((delta >> (msb - LAT_SUB_BITS)) & ((1 << LAT_SUB_BITS) - 1));
+}
+
+// Smallest delta that falls into bucket.
+uval32 LatBucketBase(int bucket)
+{
+  int msb;
+
+  if (bucket < (1 << LAT_SUB_BITS)) {
+    return bucket;
+  }
+
+  msb = (bucket >> LAT_SUB_BITS) + LAT_SUB_BITS - 1;
+  return (1u << msb) |
+    ((uval32) (bucket & ((1 << LAT_SUB_BITS) - 1)) << (msb - LAT_SUB_BITS));
+}
+
+// SYS_LAT_DUMP: prints the non-empty buckets of every band as 
+// "base count" pairs, and clears them if reset is set. Uses no memory 
+// beyond the stack.
+T_RC LatDump(bool reset)
+{
+  int band, bucket;
+  bool header;
+
+  for (band = 0; band < LAT_BANDS; band++) {
+    header = FALSE;
+    for (bucket = 0; bucket < LAT_BUCKETS; bucket++) {
+      if (!LatHist[band][bucket]) {
+        continue;
+      }
+      if (!header) {
+        myprint("priority ");
+        printHex(band << LAT_BAND_SHIFT);
+        myprint(":\n");
+        header = TRUE;
+      }
+      myprint("  ");
+      printHex(LatBucketBase(bucket));
+      myprint(" ");
+      printHex(LatHist[band][bucket]);
+      myprint("\n");
+      if (reset) {
+        LatHist[band][bucket] = 0;
+      }
+    }
+  }
+  return OK;
+}
@@ -0,0 +1,37 @@
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+#include "defines.h"
+#include "list.h"
+#include "clock.h"
+
+// Wake-to-run latency: how long a thread sits ready before it is 
+// dispatched, in ReadClock() units, kept per priority band in log 
+// bucketed histograms. Each power of two is split into 
+// 2^LAT_SUB_BITS buckets, so a bucket is never wider than 25% of its 
+// lower bound.
+#define LAT_SUB_BITS 2
+#define LAT_BUCKETS ((32 - LAT_SUB_BITS + 1) << LAT_SUB_BITS)
+
+// Priorities 0 (EDF) to MIN_PRIORITY in bands of 16.
+#define LAT_BAND_SHIFT 4
+#define LAT_BANDS ((MIN_PRIORITY >> LAT_BAND_SHIFT) + 1)
+
+extern uval32 LatHist[LAT_BANDS][LAT_BUCKETS];
+
+// Called when td becomes ready and when it is dispatched. Build with 
+// -DNO_LATENCY_STATS to take them out.
+#ifndef NO_LATENCY_STATS
+#define LAT_READY(td) ((td)->readyAt = ReadClock())
+#define LAT_DISPATCH(td) \
+  (LatHist[(td)->priority >> LAT_BAND_SHIFT][LatBucket(ReadClock() - (td)->readyAt)]++)
+#else /* NO_LATENCY_STATS */
+#define LAT_READY(td)
+#define LAT_DISPATCH(td)
+#endif /* NO_LATENCY_STATS */
+
+int LatBucket(uval32 delta);
+uval32 LatBucketBase(int bucket);
+T_RC LatDump(bool reset);
+
+#endif
@@ -0,0 +1,218 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "user.h"
+#include "lcd.h"
+#include "io.h"
+#include "waitq.h"
+
+#include <stdlib.h>
+
+// Messages posted but not yet picked up by the driver, oldest at MsgHead. 
+// The driver waits on Msgs while there are none.
+static LcdMsg Msgs[LCD_QUEUE_SIZE];
+static int MsgHead;
+static int MsgCount;
+
+// Every register access is a slow bus transaction, so the driver draws 
+// into LcdFrame and LcdFlush() only sends the cells that differ from 
+// LcdShown, which mirrors the display. Owned by the LCD driver thread.
+static char LcdShown[LCD_LINES][LCD_COLUMNS];
+static char LcdFrame[LCD_LINES][LCD_COLUMNS];
+// Where the display's cursor is, i.e. the cell the next data write goes to.
+static int CursorLine;
+static int CursorColumn;
+
+// Writes one of the display's registers.
+static void LcdOut(int reg, uval8 value)
+{
+  Io.lcd[reg] = value;
+#ifndef NATIVE
+  if (Io.lcdWatch) {
+    Io.lcdWatch(reg, value);
+  }
+#endif /* NATIVE */
+}
+
+static void CopyMsg(LcdMsg *to, LcdMsg *from)
+{
+  int i;
+
+  to->line = from->line;
+  to->clear = from->clear;
+  for (i = 0; i < LCD_COLUMNS && from->text[i]; i++) {
+    to->text[i] = from->text[i];
+  }
+  to->text[i] = '\0';
+}
+
+void InitLcd(void)
+{
+  MsgHead = 0;
+  MsgCount = 0;
+}
+
+// Passes msg to the LCD driver thread. Returns RESOURCE_ERROR if the 
+// driver is too far behind.
+T_RC LcdPost(LcdMsg *msg)
+{
+  TD *td;
+
+  if ((td = WaitqDequeue(Msgs)) != NULL) {
+    CopyMsg((LcdMsg *) td->cold->waitdata, msg);
+    td->cold->waitdata = NULL;
+    WakeThread(td);
+    return OK;
+  } else if (MsgCount < LCD_QUEUE_SIZE) {
+    CopyMsg(&Msgs[(MsgHead + MsgCount) % LCD_QUEUE_SIZE], msg);
+    MsgCount++;
+    return OK;
+  }
+  return RESOURCE_ERROR;
+}
+
+// Called by the LCD driver thread. Blocks until a message is posted.
+T_RC LcdWait(LcdMsg *msg)
+{
+  if (MsgCount > 0) {
+    CopyMsg(msg, &Msgs[MsgHead]);
+    MsgHead = (MsgHead + 1) % LCD_QUEUE_SIZE;
+    MsgCount--;
+    return OK;
+  }
+
+  Active->cold->waitdata = msg;
+  return WaitOn(Msgs);
+}
+
+// Clears the display and both buffers.
+void LcdReset(void)
+{
+  int line, column;
+
+  LcdOut(LCD_IR, LCD_CLEAR);
+  CursorLine = 0;
+  CursorColumn = 0;
+
+  for (line = 0; line < LCD_LINES; line++) {
+    for (column = 0; column < LCD_COLUMNS; column++) {
+      LcdShown[line][column] = ' ';
+      LcdFrame[line][column] = ' ';
+    }
+  }
+}
+
+// Blanks the frame buffer. Nothing is sent until LcdFlush().
+void LcdClearFrame(void)
+{
+  int line, column;
+
+  for (line = 0; line < LCD_LINES; line++) {
+    for (column = 0; column < LCD_COLUMNS; column++) {
+      LcdFrame[line][column] = ' ';
+    }
+  }
+}
+
+// Draws text into the frame buffer starting at (line, column), clipped 
+// at the end of the line. Nothing is sent until LcdFlush().
+void LcdWriteAt(int line, int column, char *text)
+{
+  if (line < 0 || line >= LCD_LINES || column < 0) {
+    return;
+  }
+
+  for (; column < LCD_COLUMNS && *text; column++, text++) {
+    LcdFrame[line][column] = *text;
+  }
+}
+
+// Counts the register writes that would bring the display from what it 
+// shows, or from blank with the cursor home if cleared is set, to the 
+// frame buffer, and makes them if send is set. The cursor advances by 
+// itself after each data write, so an address command is only needed 
+// when skipping over unchanged cells.
+static int LcdDiff(bool cleared, bool send)
+{
+  int line, column;
+  int cursorLine = cleared ? 0 : CursorLine;
+  int cursorColumn = cleared ? 0 : CursorColumn;
+  int writes = 0;
+  char shown;
+
+  for (line = 0; line < LCD_LINES; line++) {
+    for (column = 0; column < LCD_COLUMNS; column++) {
+      shown = cleared ? ' ' : LcdShown[line][column];
+      if (LcdFrame[line][column] == shown) {
+        continue;
+      }
+
+      if (line != cursorLine || column != cursorColumn) {
+        if (send) {
+          LcdOut(LCD_IR, LCD_CELL(line, column));
+        }
+        writes++;
+      }
+      if (send) {
+        LcdOut(LCD_DR, LcdFrame[line][column]);
+        LcdShown[line][column] = LcdFrame[line][column];
+      }
+      writes++;
+
+      cursorLine = line;
+      cursorColumn = column + 1;
+    }
+  }
+
+  if (send) {
+    CursorLine = cursorLine;
+    CursorColumn = cursorColumn;
+  }
+  return writes;
+}
+
+// Sends the cells of the frame buffer that changed since the last flush,
+// or, when that takes more writes, LCD_CLEAR and the frame's text. 
+// Returns the number of register writes made.
+int LcdFlush(void)
+{
+  int line, column;
+
+  if (1 + LcdDiff(TRUE, FALSE) >= LcdDiff(FALSE, FALSE)) {
+    return LcdDiff(FALSE, TRUE);
+  }
+
+  LcdOut(LCD_IR, LCD_CLEAR);
+  CursorLine = 0;
+  CursorColumn = 0;
+  for (line = 0; line < LCD_LINES; line++) {
+    for (column = 0; column < LCD_COLUMNS; column++) {
+      LcdShown[line][column] = ' ';
+    }
+  }
+  return 1 + LcdDiff(FALSE, TRUE);
+}
+
+// Draws msg into the frame buffer and sends what changed.
+void LcdPut(LcdMsg *msg)
+{
+  if (msg->clear) {
+    LcdClearFrame();
+  }
+  LcdWriteAt(msg->line, 0, msg->text);
+  LcdFlush();
+}
+
+// Entry point of the LCD driver thread. Sleeps in the kernel until there 
+// is something to display.
+void LcdDriver(void)
+{
+  LcdMsg msg;
+
+  LcdReset();
+
+  while (1) {
+    SysCall(SYS_LCD_WAIT, (uvalptr) &msg, 0, 0);
+    LcdPut(&msg);
+  }
+}
@@ -0,0 +1,42 @@
+#ifndef _LCD_H_
+#define _LCD_H_
+
+#include "defines.h"
+#include "list.h"
+
+#define LCD_LINES   2
+#define LCD_COLUMNS 16
+
+// Instruction register commands.
+#define LCD_CLEAR       0x01
+#define LCD_LINE1       0x80
+#define LCD_LINE2       0xC0
+
+// Set-address command for the cell at (line, column).
+#define LCD_CELL(line, column) (((line) ? LCD_LINE2 : LCD_LINE1) + (column))
+
+// Number of messages that can be queued for the LCD driver thread.
+#define LCD_QUEUE_SIZE 8
+
+typedef struct type_LCD_MSG LcdMsg;
+
+struct type_LCD_MSG
+{
+  // Line to write to, 0 or 1.
+  uval8 line;
+  // Blank the display before writing.
+  uval8 clear;
+  char text[LCD_COLUMNS + 1];
+};
+
+void InitLcd(void);
+T_RC LcdPost(LcdMsg *msg);
+T_RC LcdWait(LcdMsg *msg);
+void LcdReset(void);
+void LcdClearFrame(void);
+void LcdWriteAt(int line, int column, char *text);
+int LcdFlush(void);
+void LcdPut(LcdMsg *msg);
+void LcdDriver(void);
+
+#endif
@@ -0,0 +1,123 @@
+#include "defines.h"
+#include "main.h"
+#include "io.h"
+#include "lcd.h"
+#include "lcdtest.h"
+
+#ifndef NATIVE
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct type_LCD_STEP LcdStep;
+
+// One update, the register writes it should take and the display after.
+struct type_LCD_STEP
+{
+  char *what;
+  uval8 line;
+  uval8 clear;
+  char *text;
+  int writes;
+  char *shown[LCD_LINES];
+};
+
+static LcdStep Steps[] = {
+  { "first line", 0, 0, "Hello", 5, 
+    { "Hello           ", "                " } },
+  { "second line", 1, 0, "World!", 7, 
+    { "Hello           ", "World!          " } },
+  { "same again", 1, 0, "World!", 0, 
+    { "Hello           ", "World!          " } },
+  { "one cell", 0, 0, "Jello", 2, 
+    { "Jello           ", "World!          " } },
+  { "new text", 1, 0, "Count 0009", 11, 
+    { "Jello           ", "Count 0009      " } },
+  { "counter tick", 1, 0, "Count 0010", 3, 
+    { "Jello           ", "Count 0010      " } },
+  { "clear", 0, 1, "Hi", 3, 
+    { "Hi              ", "                " } },
+};
+
+// Model of the display controller: what it shows, where its cursor is, 
+// and how many writes it has been sent.
+static char Shown[LCD_LINES][LCD_COLUMNS + 1];
+static int Line;
+static int Column;
+static int Writes;
+
+static void Watch(int reg, uval8 value)
+{
+  Writes++;
+
+  if (reg == LCD_DR) {
+    if (Column < LCD_COLUMNS) {
+      Shown[Line][Column] = value;
+    }
+    Column++;
+  } else if (value == LCD_CLEAR) {
+    memset(Shown[0], ' ', LCD_COLUMNS);
+    memset(Shown[1], ' ', LCD_COLUMNS);
+    Line = 0;
+    Column = 0;
+  } else if (value >= LCD_LINE2) {
+    Line = 1;
+    Column = value - LCD_LINE2;
+  } else if (value >= LCD_LINE1) {
+    Line = 0;
+    Column = value - LCD_LINE1;
+  }
+}
+
+int LcdTest(void)
+{
+  static uval32 timer[TIMER_REGS];
+  static uval32 pushbutton[PB_REGS];
+  static uval8 lcd[LCD_REGS];
+  LcdMsg msg;
+  int i, line, total = 0, lab2 = 0, failed = 0;
+  bool ok;
+
+  InitIoMock(timer, pushbutton, lcd);
+  Io.lcdWatch = Watch;
+
+  LcdReset();
+  if (Writes != 1) {
+    printf("reset took %d writes, not 1\n", Writes);
+    failed++;
+  }
+
+  printf("%-14s %6s %8s\n", "update", "writes", "expected");
+  for (i = 0; i < sizeof(Steps) / sizeof(Steps[0]); i++) {
+    msg.line = Steps[i].line;
+    msg.clear = Steps[i].clear;
+    strcpy(msg.text, Steps[i].text);
+
+    Writes = 0;
+    LcdPut(&msg);
+    total += Writes;
+    lab2 += 1 + strlen(msg.text);
+
+    ok = Writes == Steps[i].writes;
+    for (line = 0; line < LCD_LINES; line++) {
+      if (strcmp(Shown[line], Steps[i].shown[line]) != 0) {
+	printf("%s: line %d shows \"%s\", not \"%s\"\n", Steps[i].what, line,
+	       Shown[line], Steps[i].shown[line]);
+	ok = FALSE;
+      }
+    }
+    printf("%-14s %6d %8d%s\n", Steps[i].what, Writes, Steps[i].writes,
+	   ok ? "" : "  FAILED");
+    failed += !ok;
+  }
+
+  // The lab 2 driver sent a clear and every character of each message.
+  printf("%d writes in all, %d clearing and rewriting each message\n", total,
+	 lab2);
+
+  Io.lcdWatch = NULL;
+  printf("%s\n", failed ? "FAILED" : "OK");
+  return failed ? 1 : 0;
+}
+
+#endif /* NATIVE */
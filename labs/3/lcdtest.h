@@ -0,0 +1,17 @@
+#ifndef _LCDTEST_H_
+#define _LCDTEST_H_
+
+#include "defines.h"
+
+// LCD driver test, x86 build only. With KLCDTEST set in the environment 
+// prog sends a series of typical updates through LcdPut() to mock 
+// registers, follows every register write with a model of the display 
+// controller, and checks both what ends up on the display and how many 
+// writes each update took. Exits non-zero on a mismatch.
+#define LCDTEST_ENV "KLCDTEST"
+
+#ifndef NATIVE
+int LcdTest(void);
+#endif /* NATIVE */
+
+#endif
@@ -1,26 +1,48 @@
 #include "defines.h"
 #include "list.h"
-#include "main.h"
+#include "heap.h"
+#include "klog.h"
 
 #include <stdlib.h>
 
+TD TD_TABLE[NUM_TID + 1];
+TDCold TD_COLD[NUM_TID + 1];
+
+// Initializes and returns the TD for tid, or null if tid is out of range.
 TD *CreateTD(ThreadId tid)
 {
-  TD *thread = (TD *)malloc(sizeof(TD));
+  TD *thread = NULL;
 
-  if(thread != NULL) {
+  if(tid >= 1 && tid <= NUM_TID) {
+    thread = &TD_TABLE[tid];
     thread->link = NULL;
     thread->tid = tid;
     thread->priority = 0;
     thread->waittime = 0;
     thread->inlist = NULL;
-    thread->returnCode = 0;
-
-    thread->regs.pc = 0;
-    thread->regs.sp = 0;
-    thread->regs.sr = 0;
+    thread->sched = SCHED_PRIORITY;
+    thread->deadline = 0;
+    thread->vruntime = 0;
+    thread->readyAt = 0;
+    thread->cold = &TD_COLD[tid];
+    thread->cold->returnCode = 0;
+    thread->cold->waitdata = NULL;
+    thread->cold->stack = NULL;
+    thread->cold->pool = NULL;
+    thread->cold->group = -1;
+    thread->cold->groupNext = NULL;
+    thread->cold->groupPrev = NULL;
+    thread->cold->nwait = 0;
+    thread->cold->ready = NULL;
+    thread->cold->timeout = NULL;
+    thread->cold->edf.missed = FALSE;
+    thread->cold->edf.misses = 0;
+
+    thread->cold->regs.pc = 0;
+    thread->cold->regs.sp = 0;
+    thread->cold->regs.sr = 0;
   } else {
-    myprint("Failed to allocate new thread\n");
+    KLOG_ERROR(KLOG_NO_TD, tid, 0, 0);
   }
 
   return thread;
@@ -29,12 +51,12 @@ TD *CreateTD(ThreadId tid)
 void InitTD(TD *td, uval32 pc, uval32 sp, uval32 priority) 
 { 
   if(td != NULL) {
-    td->regs.pc  = pc; 
-    td->regs.sp = sp; 
-    td->regs.sr  = DEFAULT_THREAD_SR; 
+    td->cold->regs.pc  = pc; 
+    td->cold->regs.sp = sp; 
+    td->cold->regs.sr  = DEFAULT_THREAD_SR; 
     td->priority = priority; 
   } else {
-    myprint("Tried to initialize NULL pointer\n");
+    KLOG_ERROR(KLOG_INIT_NULL_TD, 0, 0, 0);
   }
 } 
 
@@ -44,7 +66,7 @@ LL *CreateList(ListType type)
 {
   LL *newList;
 
-  if ((newList = malloc(sizeof(LL))) == NULL) {
+  if ((newList = HeapAlloc(sizeof(LL))) == NULL) {
     //printf("%s\n", "Error allocating space for a pointer to a list.");
     return NULL;
   }
@@ -55,6 +77,7 @@ LL *CreateList(ListType type)
 }
 
 int FreeQEnqueue(TD *td, LL *list) {
+	td->inlist = list;
 	if ((list->head != NULL) && (list->tail != NULL)) {
 		list->tail->link = td;
 		td->link = list->head;
@@ -70,7 +93,9 @@ int FreeQEnqueue(TD *td, LL *list) {
 }
 
 int FreeQDequeue(LL *list) {
-	if (list->head == list->tail) { // Case: only one node remaining
+	if (list->head == NULL) { // Case: every tid is in use
+		return 0;
+	} else if (list->head == list->tail) { // Case: only one node remaining
 		TD *head = list->head;
 		list->head = NULL;
 		list->tail = NULL;
@@ -133,23 +158,24 @@ RC DestroyList( LL *list )
   if(list->head){
     TD* current = list->head;
     while(current){
-      TD* old_head = DequeueHead(list);
-      free(old_head);
+      // TDs belong to TD_TABLE, only the list goes away.
+      DequeueHead(list);
       current = list->head;
     }
   }
   if (!list->head) {
-    free(list);
+    HeapFree(list);
     return RC_SUCCESS;
   } 
 
-  free(list);
+  HeapFree(list);
   return RC_FAILED;
 
 }
 
-//if list is a priority list, then enqueues td in its proper location. 
-//Returns -1 if list is not a priority list and 0 otherwise.
+//if list is a priority list, then enqueues td in its proper location, 
+//behind all TDs with higher or equal priority. Returns -1 if list is not 
+//a priority list and 0 otherwise.
 RC PriorityEnqueue(TD *td, LL *list)
 {
   TD *cur, *prev;
@@ -160,25 +186,48 @@ RC PriorityEnqueue(TD *td, LL *list)
 
     td->inlist = list;
 
-    if(!list->head){
+    prev = NULL;
+    cur = list->head;
+    while(cur && cur->priority <= td->priority){
+      prev = cur;
+      cur = cur->link;
+    }
+
+    td->link = cur;
+    if(!prev){
       list->head = td;
     } else{
-      prev = NULL;
-      cur = list->head;
-      while(cur){
-        if(cur->priority >= td->priority){
-          if(!prev){
-            td->link = list->head;
-            list->head = td;
-          } else{
-            td->link = cur;
-            prev->link = td;
-          }
-          break;
-        }
-        prev = cur;
-        cur = cur->link;
-      }
+      prev->link = td;
+    }
+    return RC_SUCCESS;
+}
+
+
+//if list is a deadline list, then enqueues td behind all TDs whose 
+//absolute deadline is earlier or equal. Returns -1 if list is not a 
+//deadline list and 0 otherwise.
+RC DeadlineEnqueue(TD *td, LL *list)
+{
+  TD *cur, *prev;
+
+    if(!td || !list || list->type != L_DEADLINE){
+      return RC_FAILED;
+    }
+
+    td->inlist = list;
+
+    prev = NULL;
+    cur = list->head;
+    while(cur && cur->deadline <= td->deadline){
+      prev = cur;
+      cur = cur->link;
+    }
+
+    td->link = cur;
+    if(!prev){
+      list->head = td;
+    } else{
+      prev->link = td;
     }
     return RC_SUCCESS;
 }
@@ -243,6 +292,7 @@ RC WaitlistEnqueue(TD *td, int waittime, LL *list)
     }
 
     if (list->head == NULL) {
+    td->link = NULL;
     list->head = td;
   } else if (waittime < (list->head)->waittime){
     td->link = list->head;
@@ -262,13 +312,17 @@ RC WaitlistEnqueue(TD *td, int waittime, LL *list)
       td->link = prev->link;
       prev->link = td;      
     } else {
+          td->link = NULL;
           prev->link = td;
     }
   }
   td->inlist = list;
   td->waittime = waittime;
 
-  waitDiff(td->link, waittime);
+  // Only the TD right behind td now waits relative to it.
+  if (td->link) {
+    td->link->waittime -= waittime;
+  }
 
   return RC_SUCCESS;
   
@@ -321,6 +375,10 @@ void DequeueTD(TD* td){
   }
 
   if (td->inlist) { // inlist is not empty 
+    // Whoever waited relative to td now waits relative to its predecessor.
+    if (td->inlist->type == L_WAITING && td->link) {
+      td->link->waittime += td->waittime;
+    }
     if(td->inlist->head == td){ // inlist only has one element
       td->inlist->head = td->link;
     } else { // inlist has at least two elements
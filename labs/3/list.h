@@ -3,16 +3,29 @@
 
 #include "defines.h"
 
-typedef enum { UNDEF, L_PRIORITY, L_LIFO, L_WAITING, L_CIRCULAR} ListType ;
+typedef enum { UNDEF, L_PRIORITY, L_LIFO, L_WAITING, L_CIRCULAR, L_DEADLINE, \
+  L_FAIR} ListType ;
+
+// Scheduling class of a thread. EDF threads run ahead of all others, fair
+// threads share one priority level by virtual runtime.
+typedef enum { SCHED_PRIORITY, SCHED_EDF, SCHED_FAIR } SchedClass;
 
 // Range of priorities [1,128]
 #define MIN_PRIORITY 128
 #define NUM_TID 1024
+// Objects a thread can wait on at once (SYS_WAIT_ANY).
+#define WAIT_MAX_OBJS 8
 
 typedef struct type_LL LL;
 typedef struct type_TD TD;
+typedef struct type_TD_COLD TDCold;
+typedef struct type_POOL Pool;
+typedef struct type_TIMER Timer;
+typedef struct type_WAIT_NODE WaitNode;
 typedef struct type_TID TID;
 typedef struct type_REGS Registers;
+typedef struct type_EDF EdfInfo;
+typedef struct type_FAIR FairInfo;
 
 struct type_REGS
 {
@@ -21,6 +34,44 @@ struct type_REGS
   uval32 sr;
 }; 
 
+// Parameters and current job of an EDF thread, all in timer ticks. The 
+// absolute deadline of the job is TD.deadline.
+struct type_EDF
+{
+  uval32 period;
+  uval32 budget;
+  // Relative to the start of each period.
+  uval32 deadline;
+  // Start of the current period.
+  uval32 release;
+  // Budget left in the current period.
+  uval32 remaining;
+  // Set once the current job has been counted as late.
+  bool missed;
+  uval32 misses;
+};
+
+// State of a fair class thread. Ready fair threads are kept in a pairing 
+// heap ordered by TD.vruntime, linked through child/sibling/prev. Read on 
+// every fair enqueue, dequeue and tick, so it lives in the TD.
+struct type_FAIR
+{
+  uval32 weight;
+  TD *child;
+  TD *sibling;
+  // Parent if this is the leftmost child, else the left sibling.
+  TD *prev;
+};
+
+// Entry of a blocked thread in the wait queue of an object (waitq.c).
+struct type_WAIT_NODE
+{
+  WaitNode *next;
+  WaitNode *prev;
+  TD *td;
+  void *obj;
+};
+
 struct type_LL
 {
   TD *head;
@@ -28,28 +79,73 @@ struct type_LL
   ListType type;
 };
 
+// The fields the scheduler reads while walking queues. Kept small so that 
+// a queue scan touches as few cache lines as possible; everything needed 
+// only once a thread is picked lives in its TDCold.
 struct type_TD
 {
   // Points to the next TD in whatever queue the TD is in
   TD * link;
+  // Identifies the queue that the thread is currently in.
+  LL * inlist;
   // The unique number that can be used to identify a thread once it has 
   // been created.
   ThreadId tid;
-  // Structure used for savinfg CPU registers and other CPU state when the 
-  // state of the thread needs to be saved.
-  Registers regs;
   // Holds the current priority of the thread by convention in systems software 
   // (particularly for UNIX), the higher the number in priority the lower the 
   // importance of the thread.
   uval32 priority;
-  // ?
+  // Scheduling class.
+  SchedClass sched;
+  // Time left relative to the TD before it in a waiting list.
   int waittime;
-  // Used to temporarily hold the return value of a system call
-  RC returnCode;
-  // Identifies the queue that the thread is currently in.
-  LL * inlist;
+  // Absolute deadline of the current job of an EDF thread.
+  uval32 deadline;
+  // CPU time received by a fair thread, scaled down by its weight, and 
+  // its place in the fair class heap.
+  uval32 vruntime;
+  FairInfo fair;
+  // ReadClock() when the thread last became ready.
+  uval32 readyAt;
+  TDCold * cold;
+};
+
+// The rest of a thread's state.
+struct type_TD_COLD
+{
+  // Structure used for savinfg CPU registers and other CPU state when the 
+  // state of the thread needs to be saved.
+  Registers regs;
+  // Result of the thread's last system call, also left in the r2 slot of
+  // its frame for the trap to return
+  sval32 returnCode;
+  // Argument of the system call the thread is blocked in. Filled in by
+  // whoever wakes the thread up.
+  void * waitdata;
+  // Bottom of the stack allocated for the thread, if any.
+  void * stack;
+  // Worker pool the thread serves, if any.
+  Pool * pool;
+  // Thread group, or -1, and the other members (group.c).
+  int group;
+  TD * groupNext;
+  TD * groupPrev;
+  // Used while the thread waits on objects; the first nwait are linked. 
+  // One more than WAIT_MAX_OBJS, for the timeout.
+  WaitNode wait[WAIT_MAX_OBJS + 1];
+  int nwait;
+  // Where to report which object woke the thread, if it asked.
+  uval32 * ready;
+  // Ends the wait if it expires first.
+  Timer * timeout;
+  EdfInfo edf;
 };
 
+// All TDs, indexed by tid, and their cold halves. Entry 1 is the idle 
+// thread.
+extern TD TD_TABLE[NUM_TID + 1];
+extern TDCold TD_COLD[NUM_TID + 1];
+
 TD *CreateTD( ThreadId tid );
 void InitTD( TD *td, uval32 pc, uval32 sp, uval32 priority );
 LL *CreateList(ListType type);
@@ -57,6 +153,7 @@ TD* DequeueHead( LL *list );
 int Dequeue( TD *td, LL *list );
 RC DestroyList( LL *list );
 RC PriorityEnqueue( TD *td, LL *list );
+RC DeadlineEnqueue( TD *td, LL *list );
 RC EnqueueAtHead( TD *td, LL *list );
 void waitDiff( TD *td, int diff );
 RC WaitlistEnqueue( TD *td, int waittime, LL *list ); 
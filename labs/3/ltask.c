@@ -0,0 +1,213 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "sched.h"
+#include "user.h"
+#include "ltask.h"
+#include "waitq.h"
+
+#include <stdlib.h>
+
+static LTask LTasks[MAX_LTASKS];
+static LTask *FreeLTasks;
+
+// Ready tasks, one FIFO per priority, and a bitmap of the non-empty ones, 
+// so that making a task ready and picking the next one do not depend on 
+// how many tasks there are.
+static LTask *ReadyHead[MIN_PRIORITY + 1];
+static LTask *ReadyTail[MIN_PRIORITY + 1];
+static uval32 ReadyMap[(MIN_PRIORITY + 32) / 32];
+
+// The thread all tasks run on, and the task it is running. The runner 
+// waits on Running while no task is ready.
+static TD *Runner;
+static LTask *Running;
+
+static void ReadyLTask(LTask *task)
+{
+  int p = task->priority;
+
+  task->state = LT_READY;
+  task->link = NULL;
+  if (ReadyTail[p]) {
+    ReadyTail[p]->link = task;
+  } else {
+    ReadyHead[p] = task;
+    ReadyMap[p / 32] |= 1 << (p % 32);
+  }
+  ReadyTail[p] = task;
+}
+
+// Removes and returns the first task of the highest ready priority.
+static LTask *PopLTask(void)
+{
+  LTask *task;
+  int i, p;
+
+  for (i = 0; i < (MIN_PRIORITY + 32) / 32; i++) {
+    if (ReadyMap[i]) {
+      break;
+    }
+  }
+  if (i == (MIN_PRIORITY + 32) / 32) {
+    return NULL;
+  }
+
+  p = i * 32 + __builtin_ctz(ReadyMap[i]);
+  task = ReadyHead[p];
+  if ((ReadyHead[p] = task->link) == NULL) {
+    ReadyTail[p] = NULL;
+    ReadyMap[p / 32] &= ~(1 << (p % 32));
+  }
+  task->link = NULL;
+  return task;
+}
+
+// Makes the runner thread as urgent as the task that just became ready, 
+// handing it a task directly if it was asleep.
+static void KickRunner(LTask *task)
+{
+  LTask *next;
+
+  if (WaitingOn(Runner, &Running)) {
+    WaitqDequeue(&Running);
+    next = PopLTask();
+    next->state = LT_RUNNING;
+    Running = next;
+    *(LTask **) Runner->cold->waitdata = next;
+    Runner->cold->waitdata = NULL;
+    Runner->priority = next->priority;
+    WakeThread(Runner);
+  } else if (task->priority < Runner->priority) {
+    if (Runner->inlist == ReadyQ) {
+      Sched->remove(Runner);
+      Runner->priority = task->priority;
+      WakeThread(Runner);
+    } else {
+      Runner->priority = task->priority;
+    }
+  }
+}
+
+void InitLTasks(void)
+{
+  int i;
+
+  FreeLTasks = NULL;
+  for (i = MAX_LTASKS - 1; i >= 0; i--) {
+    LTasks[i].id = i;
+    LTasks[i].state = LT_FREE;
+    LTasks[i].link = FreeLTasks;
+    FreeLTasks = &LTasks[i];
+  }
+
+  for (i = 0; i <= MIN_PRIORITY; i++) {
+    ReadyHead[i] = NULL;
+    ReadyTail[i] = NULL;
+  }
+  for (i = 0; i < (MIN_PRIORITY + 32) / 32; i++) {
+    ReadyMap[i] = 0;
+  }
+
+  Running = NULL;
+  if (AllocThread((uval32) (uvalptr) LTaskRunner, MIN_PRIORITY, &Runner) == OK) {
+    MakeReady(Runner);
+  } else {
+    Runner = NULL;
+  }
+}
+
+// Creates a task that runs once right away, and stores its id in *id.
+T_RC LTaskCreate(LTaskSpec *spec, uval32 *id)
+{
+  LTask *task;
+
+  if ((spec->priority < 1) || (spec->priority > MIN_PRIORITY)) {
+    return PRIORITY_ERROR;
+  } else if (!Runner || (task = FreeLTasks) == NULL) {
+    return RESOURCE_ERROR;
+  }
+  FreeLTasks = task->link;
+
+  task->fn = spec->fn;
+  task->arg = spec->arg;
+  task->priority = spec->priority;
+  task->pending = 0;
+  ReadyLTask(task);
+  KickRunner(task);
+
+  *id = task->id;
+  return OK;
+}
+
+// Makes task id run. Safe to call from interrupt handlers.
+T_RC LTaskSignal(uval32 id)
+{
+  LTask *task;
+
+  if (id >= MAX_LTASKS || LTasks[id].state == LT_FREE) {
+    return TID_ERROR;
+  }
+  task = &LTasks[id];
+
+  if (task->state == LT_IDLE) {
+    ReadyLTask(task);
+    KickRunner(task);
+  } else if (task->pending < 255) {
+    task->pending++;
+  }
+  return OK;
+}
+
+// Called by the runner with the result of the task it just ran. Stores 
+// the next task to run in *next, blocking the runner if there is none, 
+// and gives the runner that task's priority.
+T_RC LTaskNext(LTaskResult result, LTask **next)
+{
+  LTask *task;
+  uval32 priority = Active->priority;
+
+  if ((task = Running) != NULL) {
+    Running = NULL;
+    if (result == LT_DONE) {
+      task->state = LT_FREE;
+      task->link = FreeLTasks;
+      FreeLTasks = task;
+    } else if (result == LT_AGAIN || task->pending > 0) {
+      if (result != LT_AGAIN) {
+        task->pending--;
+      }
+      ReadyLTask(task);
+    } else {
+      task->state = LT_IDLE;
+    }
+  }
+
+  if ((task = PopLTask()) == NULL) {
+    Active->cold->waitdata = next;
+    return WaitOn(&Running);
+  }
+
+  task->state = LT_RUNNING;
+  Running = task;
+  *next = task;
+
+  // Dropping to a lower priority may let a thread in ahead of us.
+  Active->priority = task->priority;
+  if (task->priority > priority) {
+    Yield();
+  }
+  return OK;
+}
+
+// Entry point of the runner thread.
+void LTaskRunner(void)
+{
+  LTaskResult result = LT_WAIT;
+  LTask *task;
+
+  while (1) {
+    SysCall(SYS_LTASK_NEXT, result, (uvalptr) &task, 0);
+    result = task->fn(task);
+  }
+}
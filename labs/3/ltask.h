@@ -0,0 +1,52 @@
+#ifndef _LTASK_H_
+#define _LTASK_H_
+
+#include "defines.h"
+#include "list.h"
+
+// Light tasks are run-to-completion handlers that all run on the stack of 
+// a single runner thread, so each costs only its LTask descriptor. A task 
+// runs when signalled; its handler returns instead of blocking, keeping 
+// whatever state it needs between runs behind arg.
+#define MAX_LTASKS 2048
+
+typedef enum { LT_WAIT, LT_AGAIN, LT_DONE } LTaskResult;
+typedef enum { LT_FREE, LT_IDLE, LT_READY, LT_RUNNING } LTaskState;
+
+typedef struct type_LTASK LTask;
+typedef struct type_LTASK_SPEC LTaskSpec;
+
+// Called each time the task runs. Returns LT_WAIT to sleep until the next 
+// signal, LT_AGAIN to run again after the other tasks of its priority, or
+// LT_DONE to free the task.
+typedef LTaskResult (*LTaskFn)(LTask *self);
+
+struct type_LTASK
+{
+  // Next task in the ready list or the free list.
+  LTask *link;
+  LTaskFn fn;
+  void *arg;
+  uval32 id;
+  // Same range and meaning as a thread's priority.
+  uval8 priority;
+  uval8 state;
+  // Signals that arrived while the task was ready or running.
+  uval8 pending;
+};
+
+// Passed to SYS_LTASK_CREATE.
+struct type_LTASK_SPEC
+{
+  LTaskFn fn;
+  void *arg;
+  uval32 priority;
+};
+
+void InitLTasks(void);
+T_RC LTaskCreate(LTaskSpec *spec, uval32 *id);
+T_RC LTaskSignal(uval32 id);
+T_RC LTaskNext(LTaskResult result, LTask **next);
+void LTaskRunner(void);
+
+#endif
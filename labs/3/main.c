@@ -3,6 +3,19 @@
 #include "user.h"
 #include "kernel.h"
 #include "main.h"
+#include "trace.h"
+#include "irqsim.h"
+#include "sched.h"
+#include "syncbench.h"
+#include "wakebench.h"
+#include "rwbench.h"
+#include "heapbench.h"
+#include "clusterbench.h"
+#include "lcdtest.h"
+#include "edftest.h"
+#include "fairbench.h"
+#include "tdbench.h"
+#include "poolbench.h"
 
 #include <assert.h>
 #include <stdlib.h>
@@ -10,10 +23,78 @@
 #ifndef NATIVE
 #include <stdio.h>
 #endif /* NATIVE */
+
+// Prints num as 8 hex digits without needing printf.
+void printHex(uval32 num)
+{
+  char text[11];
+  int i;
+
+  text[0] = '0';
+  text[1] = 'x';
+  for (i = 9; i >= 2; i--) {
+    text[i] = "0123456789abcdef"[num & 0xf];
+    num >>= 4;
+  }
+  text[10] = '\0';
+
+  myprint(text);
+}
   
 int main(void)
 {   
+#ifndef NATIVE
+  if (getenv(SCHED_ENV) && SchedSelect(getenv(SCHED_ENV)) != OK) {
+    myprint("unknown scheduling policy\n");
+    return 1;
+  }
+#endif /* NATIVE */
+
   InitKernel();//Initialize all kernel data structures
+
+#ifndef NATIVE
+  if (getenv(LCDTEST_ENV)) {
+    return LcdTest();
+  }
+  if (getenv(EDFTEST_ENV)) {
+    return EdfTest(atoi(getenv(EDFTEST_ENV)));
+  }
+  if (getenv(FAIRBENCH_ENV)) {
+    return FairBench(atoi(getenv(FAIRBENCH_ENV)));
+  }
+  if (getenv(TDBENCH_ENV)) {
+    return TdBench(atoi(getenv(TDBENCH_ENV)));
+  }
+  if (getenv(POOLBENCH_ENV)) {
+    return PoolBench(atoi(getenv(POOLBENCH_ENV)));
+  }
+  if (getenv(WAKEBENCH_ENV)) {
+    return WakeBench(atoi(getenv(WAKEBENCH_ENV)));
+  }
+  if (getenv(KINFOBENCH_ENV)) {
+    KInfoBench();
+    return 0;
+  }
+  if (getenv(REPLAY_ENV)) {
+    return TraceReplay(getenv(REPLAY_ENV));
+  }
+  if (getenv(IRQSIM_ENV)) {
+    return IrqSim(atoi(getenv(IRQSIM_ENV)));
+  }
+  if (getenv(SYNCBENCH_ENV)) {
+    return SyncBench(atoi(getenv(SYNCBENCH_ENV)));
+  }
+  if (getenv(RWBENCH_ENV)) {
+    return RwBench(atoi(getenv(RWBENCH_ENV)));
+  }
+  if (getenv(HEAPBENCH_ENV)) {
+    return HeapBench(atoi(getenv(HEAPBENCH_ENV)));
+  }
+  if (getenv(CLUSTERBENCH_ENV)) {
+    return ClusterBench(atoi(getenv(CLUSTERBENCH_ENV)));
+  }
+  TraceStart(getenv(TRACE_ENV));
+#endif /* NATIVE */
   
   USERMODE;    //Switch to user mode 
 
@@ -6,11 +6,10 @@
 int main(void);
 void myprint(char *text);
 void printHex(uval32 num);
-
+void interrupt_handler(uvalptr pc);
 
 #ifdef NATIVE
 
-void interrupt_handler(void);
 void pushbutton_isr(void);
 void timer_isr(void);
 void check_exception(void);
@@ -0,0 +1,132 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "user.h"
+#include "pool.h"
+#include "waitq.h"
+
+#include <stdlib.h>
+
+static Pool Pools[MAX_POOLS];
+
+void InitPools(void)
+{
+  int i;
+
+  for (i = 0; i < MAX_POOLS; i++) {
+    Pools[i].used = FALSE;
+  }
+}
+
+// Creates a pool of `workers` threads at priority and stores its id in 
+// *pool. Returns RESOURCE_ERROR if there is no free pool, and the error 
+// from AllocThread() if not all the workers could be made; nothing is 
+// kept then.
+T_RC PoolCreate(uval32 workers, uval32 priority, int *pool)
+{
+  TD *made[POOL_MAX_WORKERS];
+  Pool *p = NULL;
+  T_RC rc;
+  int i;
+
+  if ((priority < 1) || (priority > MIN_PRIORITY)) {
+    return PRIORITY_ERROR;
+  } else if ((workers < 1) || (workers > POOL_MAX_WORKERS)) {
+    return RESOURCE_ERROR;
+  }
+
+  for (i = 0; i < MAX_POOLS; i++) {
+    if (!Pools[i].used) {
+      p = &Pools[i];
+      break;
+    }
+  }
+  if (!p) {
+    return RESOURCE_ERROR;
+  }
+
+  for (p->workers = 0; p->workers < workers; p->workers++) {
+    if ((rc = AllocThread((uval32) (uvalptr) PoolWorker, priority, 
+			  &made[p->workers])) != OK) {
+      while (p->workers > 0) {
+	ReleaseThread(made[--p->workers]);
+      }
+      return rc;
+    }
+  }
+
+  p->used = TRUE;
+  p->head = 0;
+  p->count = 0;
+
+  // Workers start by asking for a task, so they end up waiting on p 
+  // without the caller having to wait for them.
+  for (i = 0; i < workers; i++) {
+    made[i]->cold->pool = p;
+    MakeReady(made[i]);
+  }
+
+  *pool = p - Pools;
+  return OK;
+}
+
+// Hands fn(arg) to an idle worker of pool, or queues it until one is 
+// free. Returns RESOURCE_ERROR if the queue is full.
+T_RC PoolSubmit(int pool, TaskFn fn, void *arg)
+{
+  Pool *p;
+  Task *task;
+  TD *td;
+
+  if ((pool < 0) || (pool >= MAX_POOLS) || !Pools[pool].used) {
+    return FAILED;
+  }
+  p = &Pools[pool];
+
+  if ((td = WaitqDequeue(p)) != NULL) {
+    task = (Task *) td->cold->waitdata;
+    task->fn = fn;
+    task->arg = arg;
+    td->cold->waitdata = NULL;
+    WakeThread(td);
+    return OK;
+  } else if (p->count < POOL_QUEUE_SIZE) {
+    task = &p->tasks[(p->head + p->count) % POOL_QUEUE_SIZE];
+    task->fn = fn;
+    task->arg = arg;
+    p->count++;
+    return OK;
+  }
+  return RESOURCE_ERROR;
+}
+
+// Called by a worker for its next task. Blocks while the queue is empty.
+T_RC PoolWait(Task *task)
+{
+  Pool *p = Active->cold->pool;
+
+  if (!p) {
+    return FAILED;
+  }
+
+  if (p->count > 0) {
+    *task = p->tasks[p->head];
+    p->head = (p->head + 1) % POOL_QUEUE_SIZE;
+    p->count--;
+    return OK;
+  }
+
+  Active->cold->waitdata = task;
+  return WaitOn(p);
+}
+
+// Entry point of every worker thread.
+void PoolWorker(void)
+{
+  Task task;
+
+  while (1) {
+    SysCall(SYS_POOL_WAIT, (uvalptr) &task, 0, 0);
+    task.fn(task.arg);
+  }
+}
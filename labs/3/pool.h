@@ -0,0 +1,42 @@
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include "defines.h"
+#include "list.h"
+
+#define MAX_POOLS 4
+#define POOL_MAX_WORKERS 32
+// Tasks that can be waiting for a worker in each pool.
+#define POOL_QUEUE_SIZE 64
+
+typedef void (*TaskFn)(void *arg);
+
+typedef struct type_TASK Task;
+typedef struct type_POOL Pool;
+
+struct type_TASK
+{
+  TaskFn fn;
+  void *arg;
+};
+
+// A fixed set of worker threads serving a queue of tasks. Workers with 
+// nothing to do wait on the pool instead of being destroyed, so a task 
+// costs one queue insert and at most one wakeup instead of a thread.
+struct type_POOL
+{
+  bool used;
+  uval32 workers;
+  // Tasks submitted while every worker was busy, oldest at head.
+  Task tasks[POOL_QUEUE_SIZE];
+  int head;
+  int count;
+};
+
+void InitPools(void);
+T_RC PoolCreate(uval32 workers, uval32 priority, int *pool);
+T_RC PoolSubmit(int pool, TaskFn fn, void *arg);
+T_RC PoolWait(Task *task);
+void PoolWorker(void);
+
+#endif
@@ -0,0 +1,129 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "user.h"
+#include "clock.h"
+#include "kinfo.h"
+#include "pool.h"
+#include "poolbench.h"
+
+#ifndef NATIVE
+
+#include <stdio.h>
+
+static uval32 Jobs;
+static uval32 Submitted;
+static uval32 Done;
+static bool Pooled;
+static int PoolId;
+// What each worker got from SYS_POOL_WAIT.
+static Task Tasks[NUM_TID + 1];
+static volatile uval32 Sink;
+
+static void PoolBenchJob(void *arg)
+{
+  int i;
+
+  for (i = 0; i < POOLBENCH_WORK; i++) {
+    Sink += i;
+  }
+  Done++;
+}
+
+// Threads never run on x86: whichever one the kernel made Active takes 
+// its next step in Run(), as in WorkloadRun(). These only give them a pc
+// to be told apart by.
+static void PoolBenchSubmitter(void)
+{
+}
+
+static void PoolBenchJobThread(void)
+{
+}
+
+static void SubmitStep(void)
+{
+  if (Submitted == Jobs) {
+    SysCall(SYS_DIST, 0, 0, 0);
+    return;
+  }
+  Submitted++;
+  if (Pooled) {
+    SysCall(SYS_POOL_SUBMIT, PoolId, (uvalptr) PoolBenchJob, 0);
+  } else {
+    SysCall(SYS_CREATE, (uvalptr) PoolBenchJobThread, STACKSIZE, 
+	    POOLBENCH_PRIORITY);
+  }
+}
+
+static void WorkerStep(void)
+{
+  Task *task = &Tasks[GetTid()];
+
+  // A worker's first step only asks for work.
+  if (task->fn) {
+    task->fn(task->arg);
+    task->fn = NULL;
+  }
+  SysCall(SYS_POOL_WAIT, (uvalptr) task, 0, 0);
+}
+
+static void Run(char *name, bool pooled, uval32 jobs)
+{
+  uval32 start, spent, calls;
+  uval32 pc;
+
+  Jobs = jobs;
+  Submitted = 0;
+  Done = 0;
+  Pooled = pooled;
+  if (pooled && 
+      SysCall(SYS_POOL_CREATE, POOLBENCH_WORKERS, POOLBENCH_PRIORITY, 
+	      (uvalptr) &PoolId) != OK) {
+    printf("could not create the pool\n");
+    return;
+  }
+  SysCall(SYS_CREATE, (uvalptr) PoolBenchSubmitter, STACKSIZE, 
+	  POOLBENCH_SUBMIT_PRIORITY);
+
+  start = ReadClock();
+  calls = KInfoPage.syscalls;
+  while (Done < jobs) {
+    pc = Active->cold->regs.pc;
+    if (pc == (uval32) (uvalptr) PoolBenchSubmitter) {
+      SubmitStep();
+    } else if (pc == (uval32) (uvalptr) PoolWorker) {
+      WorkerStep();
+    } else if (pc == (uval32) (uvalptr) PoolBenchJobThread) {
+      PoolBenchJob(0);
+      SysCall(SYS_DIST, 0, 0, 0);
+    } else {
+      printf("%s: stuck with %u of %u jobs done\n", name, Done, jobs);
+      return;
+    }
+  }
+  spent = ReadClock() - start;
+  calls = KInfoPage.syscalls - calls;
+
+  printf("%-16s %12.0f %14.2f\n", name, 
+	 (double) jobs * CLOCK_HZ / (spent ? spent : 1), (double) calls / jobs);
+
+  // The submitter is still ready, below the jobs.
+  if (Active->cold->regs.pc == (uval32) (uvalptr) PoolBenchSubmitter) {
+    SysCall(SYS_DIST, 0, 0, 0);
+  }
+}
+
+int PoolBench(uval32 jobs)
+{
+  if (jobs == 0) {
+    jobs = 100000;
+  }
+
+  printf("%-16s %12s %14s\n", "", "jobs/s", "syscalls/job");
+  Run("thread per job", FALSE, jobs);
+  Run("pool", TRUE, jobs);
+  return 0;
+}
+
+#endif /* NATIVE */
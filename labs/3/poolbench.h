@@ -0,0 +1,23 @@
+#ifndef _POOLBENCH_H_
+#define _POOLBENCH_H_
+
+#include "defines.h"
+
+// Worker pool benchmark, x86 build only. With KPOOLBENCH=<jobs> in the 
+// environment prog has a submitting thread run <jobs> small jobs, first 
+// creating and destroying a thread for each, then handing each to a pool
+// of POOLBENCH_WORKERS workers, and prints jobs per second and kernel 
+// entries per job for both. The jobs and workers run ahead of the 
+// submitter, so every job is handed over as soon as it is submitted.
+#define POOLBENCH_ENV "KPOOLBENCH"
+#define POOLBENCH_WORKERS 4
+#define POOLBENCH_PRIORITY 10
+#define POOLBENCH_SUBMIT_PRIORITY 20
+// Iterations of busy work in each job.
+#define POOLBENCH_WORK 100
+
+#ifndef NATIVE
+int PoolBench(uval32 jobs);
+#endif /* NATIVE */
+
+#endif
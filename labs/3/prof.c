@@ -0,0 +1,127 @@
+#ifndef NATIVE
+// REG_RIP and friends.
+#define _GNU_SOURCE
+#endif /* NATIVE */
+
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "main.h"
+#include "prof.h"
+
+#ifndef NATIVE
+#include <signal.h>
+#include <ucontext.h>
+#include <sys/time.h>
+#endif /* NATIVE */
+
+static Sample Samples[PROF_SAMPLES];
+static uval32 SampleCount;
+static bool Profiling;
+
+// Called on every timer tick with the pc the tick interrupted.
+void ProfSample(uvalptr pc)
+{
+  if (!Profiling || SampleCount >= PROF_SAMPLES) {
+    return;
+  }
+
+  Samples[SampleCount].pc = pc;
+  Samples[SampleCount].tid = Active ? Active->tid : 0;
+  SampleCount++;
+}
+
+#ifndef NATIVE
+
+// There is no timer interrupt on x86, so sample the process itself.
+static void ProfSignal(int sig, siginfo_t *info, void *context)
+{
+  uvalptr pc = 0;
+
+#if defined(__x86_64__)
+  pc = ((ucontext_t *) context)->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+  pc = ((ucontext_t *) context)->uc_mcontext.gregs[REG_EIP];
+#endif
+
+  ProfSample(pc);
+}
+
+static void HostTimer(bool on)
+{
+  struct sigaction action;
+  struct itimerval timer;
+
+  if (on) {
+    action.sa_sigaction = ProfSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, NULL);
+  }
+
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_usec = on ? 1000000 / PROF_HOST_HZ : 0;
+  timer.it_value = timer.it_interval;
+  setitimer(ITIMER_PROF, &timer, NULL);
+}
+
+#endif /* NATIVE */
+
+// SYS_PROF: PROF_START clears the buffer and starts sampling, PROF_STOP 
+// stops it and PROF_DUMP prints the samples.
+T_RC ProfControl(ProfOp op)
+{
+  switch (op) {
+  case PROF_START:
+    SampleCount = 0;
+    Profiling = TRUE;
+#ifndef NATIVE
+    HostTimer(TRUE);
+#endif /* NATIVE */
+    return OK;
+  case PROF_STOP:
+    Profiling = FALSE;
+#ifndef NATIVE
+    HostTimer(FALSE);
+#endif /* NATIVE */
+    return OK;
+  case PROF_DUMP:
+    ProfDump();
+    return OK;
+  }
+  return FAILED;
+}
+
+static void PrintAddr(uvalptr addr)
+{
+  char text[2 * sizeof(uvalptr) + 1];
+  int i;
+
+  for (i = 2 * sizeof(uvalptr) - 1; i >= 0; i--) {
+    text[i] = "0123456789abcdef"[addr & 0xf];
+    addr >>= 4;
+  }
+  text[2 * sizeof(uvalptr)] = '\0';
+
+  myprint(text);
+}
+
+// Prints the samples in the format profview reads: a "B" line with the 
+// run-time address of ProfDump, so that profview can undo relocation, 
+// then one "S tid pc" line per sample.
+void ProfDump(void)
+{
+  uval32 i;
+
+  myprint("B ");
+  PrintAddr((uvalptr) ProfDump);
+  myprint("\n");
+
+  for (i = 0; i < SampleCount; i++) {
+    myprint("S ");
+    PrintAddr(Samples[i].tid);
+    myprint(" ");
+    PrintAddr(Samples[i].pc);
+    myprint("\n");
+  }
+}
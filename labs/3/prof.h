@@ -0,0 +1,28 @@
+#ifndef _PROF_H_
+#define _PROF_H_
+
+#include "defines.h"
+
+// Statistical profiler: on every timer tick the interrupted pc and the 
+// Active tid are stored, until the buffer is full. profview maps the 
+// dumped samples onto the symbols of prog.
+#define PROF_SAMPLES 4096
+
+// Host sampling rate, driven by SIGPROF.
+#define PROF_HOST_HZ 1000
+
+typedef enum { PROF_START, PROF_STOP, PROF_DUMP } ProfOp;
+
+typedef struct type_SAMPLE Sample;
+
+struct type_SAMPLE
+{
+  uvalptr pc;
+  ThreadId tid;
+};
+
+void ProfSample(uvalptr pc);
+T_RC ProfControl(ProfOp op);
+void ProfDump(void);
+
+#endif
@@ -0,0 +1,226 @@
+// Host side of the sampling profiler. Reads the output of 
+// SYS_PROF(PROF_DUMP) and the symbol table of the program that produced it,
+// and prints a flat profile per thread.
+//
+//   usage: profview prog samples
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SYMS 8192
+#define MAX_NAME 128
+
+typedef struct type_SYM Sym;
+
+struct type_SYM
+{
+  unsigned long addr;
+  // First address past the symbol.
+  unsigned long end;
+  char name[MAX_NAME];
+  unsigned long hits;
+};
+
+typedef struct type_THREAD_PROF ThreadProf;
+
+// One thread's histogram over the symbol table.
+struct type_THREAD_PROF
+{
+  unsigned long tid;
+  unsigned long total;
+  unsigned long *hits;
+  ThreadProf *next;
+};
+
+static Sym Syms[MAX_SYMS];
+static int NumSyms;
+
+// Loads the text symbols of prog, sorted by address. Each one ends where 
+// nm -S says or, for symbols without a size such as those defined in 
+// assembly, at the next symbol of any kind. One still open at the end of
+// the table covers nothing.
+static int LoadSyms(char *prog)
+{
+  char cmd[512];
+  char line[512];
+  char name[MAX_NAME];
+  char type;
+  unsigned long addr;
+  unsigned long size;
+  // First of the symbols still waiting for an end, or -1.
+  int open = -1;
+  FILE *nm;
+
+  snprintf(cmd, sizeof(cmd), "nm -n -S %s", prog);
+  nm = popen(cmd, "r");
+  if (!nm) {
+    return -1;
+  }
+
+  while (fgets(line, sizeof(line), nm) && NumSyms < MAX_SYMS) {
+    if (sscanf(line, "%lx %lx %c %127s", &addr, &size, &type, name) != 4) {
+      size = 0;
+      if (sscanf(line, "%lx %c %127s", &addr, &type, name) != 3) {
+	continue;
+      }
+    }
+    if (open >= 0 && addr > Syms[open].addr) {
+      for (; open < NumSyms; open++) {
+	if (Syms[open].end == Syms[open].addr) {
+	  Syms[open].end = addr;
+	}
+      }
+      open = -1;
+    }
+    if (type != 'T' && type != 't' && type != 'W' && type != 'w') {
+      continue;
+    }
+    Syms[NumSyms].addr = addr;
+    Syms[NumSyms].end = addr + size;
+    strcpy(Syms[NumSyms].name, name);
+    if (!size && open < 0) {
+      open = NumSyms;
+    }
+    NumSyms++;
+  }
+
+  pclose(nm);
+  return NumSyms;
+}
+
+static Sym *FindSym(char *name)
+{
+  int i;
+
+  for (i = 0; i < NumSyms; i++) {
+    if (strcmp(Syms[i].name, name) == 0) {
+      return &Syms[i];
+    }
+  }
+  return NULL;
+}
+
+// Index of the symbol containing addr, or -1 if addr lies before the 
+// first symbol or past the end of the one below it.
+static int Lookup(unsigned long addr)
+{
+  int lo = 0;
+  int hi = NumSyms - 1;
+  int found = -1;
+
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+
+    if (Syms[mid].addr <= addr) {
+      found = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  if (found >= 0 && addr >= Syms[found].end) {
+    return -1;
+  }
+  return found;
+}
+
+static ThreadProf *GetThread(ThreadProf **threads, unsigned long tid)
+{
+  ThreadProf *t;
+
+  for (t = *threads; t; t = t->next) {
+    if (t->tid == tid) {
+      return t;
+    }
+  }
+
+  t = calloc(1, sizeof(ThreadProf));
+  t->tid = tid;
+  t->hits = calloc(NumSyms + 1, sizeof(unsigned long));
+  t->next = *threads;
+  *threads = t;
+  return t;
+}
+
+static unsigned long *SortHits;
+
+static int ByHits(const void *a, const void *b)
+{
+  unsigned long ha = SortHits[*(const int *) a];
+  unsigned long hb = SortHits[*(const int *) b];
+
+  return ha < hb ? 1 : ha > hb ? -1 : 0;
+}
+
+static void PrintThread(ThreadProf *t)
+{
+  int *order = malloc((NumSyms + 1) * sizeof(int));
+  int i;
+
+  for (i = 0; i <= NumSyms; i++) {
+    order[i] = i;
+  }
+  SortHits = t->hits;
+  qsort(order, NumSyms + 1, sizeof(int), ByHits);
+
+  printf("thread %lu: %lu samples\n", t->tid, t->total);
+  for (i = 0; i <= NumSyms && t->hits[order[i]]; i++) {
+    int s = order[i];
+
+    printf("  %6.2f%% %8lu  %s\n", 100.0 * t->hits[s] / t->total, t->hits[s],
+	   s == NumSyms ? "<unknown>" : Syms[s].name);
+  }
+
+  free(order);
+}
+
+int main(int argc, char **argv)
+{
+  char line[256];
+  unsigned long base;
+  unsigned long tid;
+  unsigned long pc;
+  long bias = 0;
+  ThreadProf *threads = NULL;
+  ThreadProf *t;
+  Sym *anchor;
+  FILE *in;
+
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s prog samples\n", argv[0]);
+    return 1;
+  }
+
+  if (LoadSyms(argv[1]) <= 0) {
+    fprintf(stderr, "%s: no symbols in %s\n", argv[0], argv[1]);
+    return 1;
+  }
+  anchor = FindSym("ProfDump");
+
+  in = fopen(argv[2], "r");
+  if (!in) {
+    perror(argv[2]);
+    return 1;
+  }
+
+  while (fgets(line, sizeof(line), in)) {
+    if (sscanf(line, "B %lx", &base) == 1) {
+      // The program may have been loaded somewhere other than where nm 
+      // says (position independent executables).
+      bias = anchor ? (long) (base - anchor->addr) : 0;
+    } else if (sscanf(line, "S %lx %lx", &tid, &pc) == 2) {
+      int s = Lookup(pc - bias);
+
+      t = GetThread(&threads, tid);
+      t->hits[s < 0 ? NumSyms : s]++;
+      t->total++;
+    }
+  }
+  fclose(in);
+
+  for (t = threads; t; t = t->next) {
+    PrintThread(t);
+  }
+  return 0;
+}
@@ -0,0 +1,125 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "user.h"
+#include "clock.h"
+#include "kinfo.h"
+#include "rwlock.h"
+#include "rwbench.h"
+
+#ifndef NATIVE
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Where each thread is in its critical section. Threads never run on 
+// x86, so whichever one the kernel made Active takes its next step here,
+// as in WorkloadRun().
+typedef enum { RB_OUTSIDE, RB_ENTERED, RB_INSIDE } RwBenchPhase;
+
+static RwBenchPhase Phase[NUM_TID + 1];
+static bool Writing[NUM_TID + 1];
+// Threads holding the lock, to check that it excludes what it should.
+static uval32 Readers, Writers, Violations;
+
+static void Step(RwLock *l, bool exclusive, bool yield, bool *done)
+{
+  ThreadId tid = GetTid();
+
+  switch (Phase[tid]) {
+  case RB_OUTSIDE:
+    Writing[tid] = exclusive || rand() % 100 < RWBENCH_WRITE_PCT;
+    // If this blocks, the thread holds the lock when it next runs.
+    Phase[tid] = RB_ENTERED;
+    if (Writing[tid]) {
+      RwWriteLock(l);
+    } else {
+      RwReadLock(l);
+    }
+    break;
+  case RB_ENTERED:
+    Phase[tid] = RB_INSIDE;
+    if (Writers || (Writing[tid] && Readers)) {
+      Violations++;
+    }
+    if (Writing[tid]) {
+      Writers++;
+    } else {
+      Readers++;
+    }
+    if (yield) {
+      SysCall(SYS_YIELD, 0, 0, 0);
+      break;
+    }
+    // Fall through.
+  case RB_INSIDE:
+    Phase[tid] = RB_OUTSIDE;
+    if (Writing[tid]) {
+      Writers--;
+      RwWriteUnlock(l);
+    } else {
+      Readers--;
+      RwReadUnlock(l);
+    }
+    *done = TRUE;
+    break;
+  }
+}
+
+static void Run(char *name, bool exclusive, bool yield, uval32 ops)
+{
+  RwLock lock = RW_INITIALIZER;
+  uval32 start, spent, calls, yields;
+  uval32 finished = 0;
+  bool done;
+  int i;
+
+  for (i = 0; i < RWBENCH_THREADS; i++) {
+    SysCall(SYS_CREATE, (uvalptr) RwBench, STACKSIZE, RWBENCH_PRIORITY);
+  }
+  for (i = 0; i <= NUM_TID; i++) {
+    Phase[i] = RB_OUTSIDE;
+  }
+  Readers = Writers = Violations = 0;
+
+  start = ReadClock();
+  calls = KInfoPage.syscalls;
+  yields = yield ? ops : 0;
+  while (finished < ops) {
+    done = FALSE;
+    Step(&lock, exclusive, yield, &done);
+    finished += done;
+  }
+  spent = ReadClock() - start;
+  calls = KInfoPage.syscalls - calls - yields;
+
+  printf("%-9s %-8s %12.0f %14.2f\n", name, yield ? "yes" : "no",
+	 (double) ops * CLOCK_HZ / (spent ? spent : 1), (double) calls / ops);
+  if (Violations) {
+    printf("  %u sections were not excluded\n", Violations);
+  }
+
+  // Some may still be queued on the lock, which is about to go away.
+  for (i = IDLE_TID + 1; i <= NUM_TID; i++) {
+    if (tidInUse(i) && TD_TABLE[i].cold->regs.pc == (uval32) (uvalptr) RwBench) {
+      SysCall(SYS_DIST, i, 0, 0);
+    }
+  }
+}
+
+int RwBench(uval32 ops)
+{
+  if (ops == 0) {
+    ops = 100000;
+  }
+
+  srand(1);
+  printf("lock      switched   sections/s  lock calls/section\n");
+  Run("rwlock", FALSE, FALSE, ops);
+  Run("exclusive", TRUE, FALSE, ops);
+  Run("rwlock", FALSE, TRUE, ops);
+  Run("exclusive", TRUE, TRUE, ops);
+  return 0;
+}
+
+#endif /* NATIVE */
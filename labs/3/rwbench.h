@@ -0,0 +1,22 @@
+#ifndef _RWBENCH_H_
+#define _RWBENCH_H_
+
+#include "defines.h"
+
+// Read-mostly lock benchmark, x86 build only. With KRWBENCH=<ops> in the 
+// environment prog runs RWBENCH_THREADS threads through <ops> critical 
+// sections, RWBENCH_WRITE_PCT% of them writes, first straight through 
+// and then giving up the processor once inside each. It does so with the
+// rwlock, and with every section exclusive as with a plain mutex, and 
+// prints the throughput and how often the kernel was entered for the 
+// lock.
+#define RWBENCH_ENV "KRWBENCH"
+#define RWBENCH_THREADS 16
+#define RWBENCH_WRITE_PCT 5
+#define RWBENCH_PRIORITY 10
+
+#ifndef NATIVE
+int RwBench(uval32 ops);
+#endif /* NATIVE */
+
+#endif
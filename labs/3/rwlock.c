@@ -0,0 +1,144 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "user.h"
+#include "atomic.h"
+#include "rwlock.h"
+#include "waitq.h"
+
+// Thread side. Each fast path is one AtomicCas() that only succeeds 
+// while nobody is queued.
+
+void RwReadLock(RwLock *l)
+{
+  uval32 s = l->state;
+
+  if ((s & (RW_WRITER | RW_WAITERS)) || AtomicCas(&l->state, s, s + 1) != s) {
+    SysCall(SYS_RW_READ, (uvalptr) l, 0, 0);
+  }
+}
+
+void RwReadUnlock(RwLock *l)
+{
+  uval32 s;
+
+  do {
+    s = l->state;
+    if (s & RW_WAITERS) {
+      SysCall(SYS_RW_UNLOCK, (uvalptr) l, 0, 0);
+      return;
+    }
+  } while (AtomicCas(&l->state, s, s - 1) != s);
+}
+
+void RwWriteLock(RwLock *l)
+{
+  if (AtomicCas(&l->state, 0, RW_WRITER) != 0) {
+    SysCall(SYS_RW_WRITE, (uvalptr) l, 0, 0);
+  }
+}
+
+void RwWriteUnlock(RwLock *l)
+{
+  if (AtomicCas(&l->state, RW_WRITER, 0) != RW_WRITER) {
+    SysCall(SYS_RW_UNLOCK, (uvalptr) l, 0, 0);
+  }
+}
+
+// Kernel side. System calls run with interrupts off on one processor, 
+// so they can update state with plain loads and stores.
+
+static void SetWaiters(RwLock *l)
+{
+  if (l->waiting) {
+    l->state |= RW_WAITERS;
+  } else {
+    l->state &= ~RW_WAITERS;
+  }
+}
+
+// waiting counts the threads that queued, but one destroyed while queued
+// leaves the count without leaving a waiter to wake. So the two hand-off
+// routines below trust what WakeOne() and WakeN() find, not the count, 
+// and drop whatever is left of it.
+
+// Gives the free lock to the longest waiting writer of the highest 
+// priority, if there is one.
+static bool HandToWriter(RwLock *l)
+{
+  if (!(l->waiting >> 16)) {
+    return FALSE;
+  }
+  if (!WakeOne((void *) &l->state)) {
+    l->waiting &= RW_READERS;
+    return FALSE;
+  }
+  l->waiting -= RW_WRITER_ONE;
+  l->state |= RW_WRITER;
+  return TRUE;
+}
+
+// Lets every queued reader into the free lock at once. Returns how many 
+// came in.
+static uval32 AdmitReaders(RwLock *l)
+{
+  uval32 woken;
+
+  if (!(l->waiting & RW_READERS)) {
+    return 0;
+  }
+  l->waiting &= ~RW_READERS;
+  woken = WakeN(&l->waiting, 0);
+  l->state += woken;
+  return woken;
+}
+
+// SYS_RW_READ: the fast path failed. Readers wait while a writer holds 
+// the lock or waits for it.
+T_RC RwRead(RwLock *l)
+{
+  if (!(l->state & RW_WRITER) && !(l->waiting >> 16)) {
+    l->state++;
+    return OK;
+  }
+
+  l->waiting++;
+  SetWaiters(l);
+  // Whoever wakes us has counted us in already.
+  return WaitOn(&l->waiting);
+}
+
+// SYS_RW_WRITE
+T_RC RwWrite(RwLock *l)
+{
+  if (!(l->state & (RW_WRITER | RW_READERS))) {
+    l->state |= RW_WRITER;
+    return OK;
+  }
+
+  l->waiting += RW_WRITER_ONE;
+  SetWaiters(l);
+  return WaitOn((void *) &l->state);
+}
+
+// SYS_RW_UNLOCK: releases a read or write hold while threads are queued.
+T_RC RwUnlock(RwLock *l)
+{
+  if (l->state & RW_WRITER) {
+    l->state &= ~RW_WRITER;
+    if (!AdmitReaders(l)) {
+      HandToWriter(l);
+    }
+  } else if (l->state & RW_READERS) {
+    l->state--;
+    // Readers only queue behind a writer, but that one may be gone.
+    if (!(l->state & RW_READERS) && !HandToWriter(l)) {
+      AdmitReaders(l);
+    }
+  } else {
+    return FAILED;
+  }
+
+  SetWaiters(l);
+  return OK;
+}
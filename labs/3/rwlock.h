@@ -0,0 +1,41 @@
+#ifndef _RWLOCK_H_
+#define _RWLOCK_H_
+
+#include "defines.h"
+
+// Reader-writer lock living in thread memory. state holds the number of 
+// readers inside and two flags; while neither flag is set, taking and 
+// releasing the lock is one AtomicCas() without entering the kernel. 
+// Everything else goes through SYS_RW_*, which own `waiting`.
+//
+// Writers are preferred: once one is waiting, new readers queue behind 
+// it. A writer's release admits every queued reader at once with one 
+// WakeN(); the next writer goes when they are done.
+#define RW_WRITER  0x80000000
+// Someone is queued in the kernel: take the slow path.
+#define RW_WAITERS 0x40000000
+#define RW_READERS 0x0000FFFF
+
+// waiting: writers in the high half, readers in the low half.
+#define RW_WRITER_ONE 0x10000
+
+typedef struct type_RWLOCK RwLock;
+
+struct type_RWLOCK
+{
+  volatile uval32 state;
+  uval32 waiting;
+};
+
+#define RW_INITIALIZER { 0, 0 }
+
+void RwReadLock(RwLock *l);
+void RwReadUnlock(RwLock *l);
+void RwWriteLock(RwLock *l);
+void RwWriteUnlock(RwLock *l);
+
+T_RC RwRead(RwLock *l);
+T_RC RwWrite(RwLock *l);
+T_RC RwUnlock(RwLock *l);
+
+#endif
@@ -0,0 +1,136 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "klog.h"
+#include "sched.h"
+
+#include <string.h>
+
+static SchedPolicy *Policies[] = { &ListPolicy, &BitmapPolicy };
+
+SchedPolicy *Sched;
+
+// Picks the policy called name. Only meaningful before InitKernel().
+T_RC SchedSelect(char *name)
+{
+  int i;
+
+  for (i = 0; i < sizeof(Policies) / sizeof(Policies[0]); i++) {
+    if (!strcmp(Policies[i]->name, name)) {
+      Sched = Policies[i];
+      return OK;
+    }
+  }
+  return FAILED;
+}
+
+// The original ready queue: one list sorted by priority, FIFO within a 
+// priority. Enqueueing walks the list, dequeueing is O(1).
+
+static void ListInit(void)
+{
+}
+
+static void ListEnqueue(TD *td)
+{
+  PriorityEnqueue(td, ReadyQ);
+}
+
+static TD *ListDequeue(void)
+{
+  return DequeueHead(ReadyQ);
+}
+
+static TD *ListPeek(void)
+{
+  return ReadyQ->head;
+}
+
+static void ListRemove(TD *td)
+{
+  if (!Dequeue(td, ReadyQ)) {
+    KLOG_ERROR(KLOG_DEQUEUE_ERROR, td->tid, td->priority, 0);
+  }
+}
+
+static void ListRequeue(TD *td, uval32 priority)
+{
+  ListRemove(td);
+  td->priority = priority;
+  PriorityEnqueue(td, ReadyQ);
+}
+
+// Sorts the batch by priority, keeping the given order within a 
+// priority, and merges it into the list in one walk.
+static void ListEnqueueBatch(TD **tds, int n)
+{
+  TD *td, *cur, *prev;
+  int i, j;
+
+  for (i = 1; i < n; i++) {
+    td = tds[i];
+    for (j = i; j > 0 && tds[j - 1]->priority > td->priority; j--) {
+      tds[j] = tds[j - 1];
+    }
+    tds[j] = td;
+  }
+
+  prev = NULL;
+  cur = ReadyQ->head;
+  for (i = 0; i < n; i++) {
+    td = tds[i];
+    while (cur && cur->priority <= td->priority) {
+      prev = cur;
+      cur = cur->link;
+    }
+    td->inlist = ReadyQ;
+    td->link = cur;
+    if (prev) {
+      prev->link = td;
+    } else {
+      ReadyQ->head = td;
+    }
+    prev = td;
+  }
+}
+
+// Marks the batch, then unlinks every marked thread in one walk.
+static void ListRemoveBatch(TD **tds, int n)
+{
+  static bool removing[NUM_TID + 1];
+  TD *cur, *prev;
+  int i;
+
+  for (i = 0; i < n; i++) {
+    removing[tds[i]->tid] = TRUE;
+  }
+
+  prev = NULL;
+  for (cur = ReadyQ->head; cur && n > 0; cur = cur->link) {
+    if (!removing[cur->tid]) {
+      prev = cur;
+      continue;
+    }
+    if (prev) {
+      prev->link = cur->link;
+    } else {
+      ReadyQ->head = cur->link;
+    }
+    removing[cur->tid] = FALSE;
+    n--;
+  }
+
+  // Any left were not queued.
+  for (i = 0; i < n; i++) {
+    removing[tds[i]->tid] = FALSE;
+  }
+}
+
+static void ListTick(void)
+{
+}
+
+SchedPolicy ListPolicy = {
+  "list", ListInit, ListEnqueue, ListDequeue, ListPeek, ListRequeue, 
+  ListRemove, ListEnqueueBatch, ListRemoveBatch, ListTick
+};
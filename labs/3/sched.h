@@ -0,0 +1,46 @@
+#ifndef _SCHED_H_
+#define _SCHED_H_
+
+#include "defines.h"
+#include "list.h"
+
+// How priority class threads are queued while ready. The kernel only goes
+// through these operations, so the ready queue can be implemented in 
+// more than one way. Every queued TD has ReadyQ as its inlist.
+typedef struct type_SCHED_POLICY SchedPolicy;
+
+struct type_SCHED_POLICY
+{
+  char *name;
+  void (*init)(void);
+  // Queues td behind the threads of its priority.
+  void (*enqueue)(TD *td);
+  // Takes the most urgent thread off, or returns NULL.
+  TD *(*dequeue)(void);
+  TD *(*peek)(void);
+  // Moves a queued td to priority.
+  void (*requeue)(TD *td, uval32 priority);
+  void (*remove)(TD *td);
+  // As enqueue and remove for n threads at once, in one pass over the 
+  // queue where the policy can.
+  void (*enqueueBatch)(TD **tds, int n);
+  void (*removeBatch)(TD **tds, int n);
+  // Called on every timer tick.
+  void (*tick)(void);
+};
+
+// Policy used unless another one is selected before InitKernel(). Build 
+// with -DSCHED_DEFAULT=\"bitmap\" to change it; on x86 $SCHED_POLICY 
+// also selects one at boot.
+#ifndef SCHED_DEFAULT
+#define SCHED_DEFAULT "list"
+#endif
+#define SCHED_ENV "SCHED_POLICY"
+
+extern SchedPolicy *Sched;
+extern SchedPolicy ListPolicy;
+extern SchedPolicy BitmapPolicy;
+
+T_RC SchedSelect(char *name);
+
+#endif
@@ -0,0 +1,236 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "sync.h"
+#include "waitq.h"
+
+static Barrier Barriers[MAX_BARRIERS];
+static Latch Latches[MAX_LATCHES];
+static Semaphore Semaphores[MAX_SEMAPHORES];
+
+void InitSync(void)
+{
+  int i;
+
+  for (i = 0; i < MAX_BARRIERS; i++) {
+    Barriers[i].used = FALSE;
+  }
+  for (i = 0; i < MAX_LATCHES; i++) {
+    Latches[i].used = FALSE;
+  }
+  for (i = 0; i < MAX_SEMAPHORES; i++) {
+    Semaphores[i].used = FALSE;
+  }
+}
+
+// Creates a barrier for groups of `parties` threads and stores its id in
+// *barrier.
+T_RC BarrierCreate(uval32 parties, int *barrier)
+{
+  int i;
+
+  if (parties < 1 || parties > NUM_TID) {
+    return FAILED;
+  }
+
+  for (i = 0; i < MAX_BARRIERS; i++) {
+    if (!Barriers[i].used) {
+      Barriers[i].used = TRUE;
+      Barriers[i].parties = parties;
+      Barriers[i].arrived = 0;
+      *barrier = i;
+      return OK;
+    }
+  }
+  return RESOURCE_ERROR;
+}
+
+// Blocks until `parties` threads have arrived. The last one to arrive 
+// does not block; it releases the others.
+T_RC BarrierWait(int barrier)
+{
+  Barrier *b;
+
+  if ((barrier < 0) || (barrier >= MAX_BARRIERS) || !Barriers[barrier].used) {
+    return FAILED;
+  }
+  b = &Barriers[barrier];
+
+  if (++b->arrived < b->parties) {
+    return WaitOn(b);
+  }
+
+  // A party destroyed while waiting left the queue but not the count, so
+  // count the ones really there before releasing them; once a phase.
+  if ((b->arrived = Waiters(b) + 1) < b->parties) {
+    return WaitOn(b);
+  }
+
+  b->arrived = 0;
+  WakeN(b, 0);
+  return OK;
+}
+
+// Fails while threads are waiting at the barrier.
+T_RC BarrierDestroy(int barrier)
+{
+  if ((barrier < 0) || (barrier >= MAX_BARRIERS) || !Barriers[barrier].used ||
+      Waited(&Barriers[barrier])) {
+    return FAILED;
+  }
+  Barriers[barrier].used = FALSE;
+  return OK;
+}
+
+// Creates a latch that opens after count calls to LatchCountDown() and 
+// stores its id in *latch.
+T_RC LatchCreate(uval32 count, int *latch)
+{
+  int i;
+
+  for (i = 0; i < MAX_LATCHES; i++) {
+    if (!Latches[i].used) {
+      Latches[i].used = TRUE;
+      Latches[i].count = count;
+      *latch = i;
+      return OK;
+    }
+  }
+  return RESOURCE_ERROR;
+}
+
+T_RC LatchCountDown(int latch)
+{
+  Latch *l;
+
+  if ((latch < 0) || (latch >= MAX_LATCHES) || !Latches[latch].used) {
+    return FAILED;
+  }
+  l = &Latches[latch];
+
+  if (l->count > 0 && --l->count == 0) {
+    WakeN(l, 0);
+  }
+  return OK;
+}
+
+// Blocks until the latch is open.
+T_RC LatchWait(int latch)
+{
+  Latch *l;
+
+  if ((latch < 0) || (latch >= MAX_LATCHES) || !Latches[latch].used) {
+    return FAILED;
+  }
+  l = &Latches[latch];
+
+  if (l->count > 0) {
+    return WaitOn(l);
+  }
+  return OK;
+}
+
+// Fails while the latch is closed, since threads may be waiting on it.
+T_RC LatchDestroy(int latch)
+{
+  if ((latch < 0) || (latch >= MAX_LATCHES) || !Latches[latch].used ||
+      Latches[latch].count) {
+    return FAILED;
+  }
+  Latches[latch].used = FALSE;
+  return OK;
+}
+
+// For SYS_WAIT_ANY: returns the object to wait on for the latch to open,
+// or null if there is no such latch. Sets *ready, if given, if it is 
+// open.
+void *LatchWaitable(int latch, bool *ready)
+{
+  if ((latch < 0) || (latch >= MAX_LATCHES) || !Latches[latch].used) {
+    return NULL;
+  }
+  if (ready) {
+    *ready = Latches[latch].count == 0;
+  }
+  return &Latches[latch];
+}
+
+// Creates a semaphore holding count units and stores its id in *sem.
+T_RC SemCreate(uval32 count, int *sem)
+{
+  int i;
+
+  for (i = 0; i < MAX_SEMAPHORES; i++) {
+    if (!Semaphores[i].used) {
+      Semaphores[i].used = TRUE;
+      Semaphores[i].count = count;
+      *sem = i;
+      return OK;
+    }
+  }
+  return RESOURCE_ERROR;
+}
+
+T_RC SemPost(int sem)
+{
+  Semaphore *s;
+  TD *td;
+
+  if ((sem < 0) || (sem >= MAX_SEMAPHORES) || !Semaphores[sem].used) {
+    return FAILED;
+  }
+  s = &Semaphores[sem];
+
+  if ((td = WaitqDequeue(s)) != NULL) {
+    WakeThread(td);
+  } else {
+    s->count++;
+  }
+  return OK;
+}
+
+// Takes a unit, blocking until there is one.
+T_RC SemWait(int sem)
+{
+  Semaphore *s;
+
+  if ((sem < 0) || (sem >= MAX_SEMAPHORES) || !Semaphores[sem].used) {
+    return FAILED;
+  }
+  s = &Semaphores[sem];
+
+  if (s->count > 0) {
+    s->count--;
+    return OK;
+  }
+  return WaitOn(s);
+}
+
+// Fails while threads are waiting on the semaphore.
+T_RC SemDestroy(int sem)
+{
+  if ((sem < 0) || (sem >= MAX_SEMAPHORES) || !Semaphores[sem].used ||
+      Waited(&Semaphores[sem])) {
+    return FAILED;
+  }
+  Semaphores[sem].used = FALSE;
+  return OK;
+}
+
+// For SYS_WAIT_ANY: returns the object to wait on for a unit, or null if
+// there is no such semaphore. Sets *ready, if given, taking a unit, if 
+// there is one.
+void *SemWaitable(int sem, bool *ready)
+{
+  Semaphore *s;
+
+  if ((sem < 0) || (sem >= MAX_SEMAPHORES) || !Semaphores[sem].used) {
+    return NULL;
+  }
+  s = &Semaphores[sem];
+
+  if (ready && (*ready = s->count > 0)) {
+    s->count--;
+  }
+  return s;
+}
@@ -0,0 +1,58 @@
+#ifndef _SYNC_H_
+#define _SYNC_H_
+
+#include "defines.h"
+
+// Rendezvous objects. Threads block on them in the kernel instead of 
+// spinning with Yield(), and whoever completes the count releases every 
+// waiter with one WakeN(), i.e. one scheduling decision.
+#define MAX_BARRIERS 16
+#define MAX_LATCHES 16
+#define MAX_SEMAPHORES 16
+
+typedef struct type_BARRIER Barrier;
+typedef struct type_LATCH Latch;
+typedef struct type_SEMAPHORE Semaphore;
+
+// Reusable: releases each group of `parties` arrivals and starts over.
+struct type_BARRIER
+{
+  bool used;
+  uval32 parties;
+  // Arrivals of this group, counting any destroyed while waiting until 
+  // the last arrival recounts them.
+  uval32 arrived;
+};
+
+// One shot: waiters are released once count reaches 0, and later waits 
+// return at once.
+struct type_LATCH
+{
+  bool used;
+  uval32 count;
+};
+
+// Counting: a post wakes one waiter, handing it the unit, or adds one to 
+// count for the next wait.
+struct type_SEMAPHORE
+{
+  bool used;
+  uval32 count;
+};
+
+void InitSync(void);
+T_RC BarrierCreate(uval32 parties, int *barrier);
+T_RC BarrierWait(int barrier);
+T_RC BarrierDestroy(int barrier);
+T_RC LatchCreate(uval32 count, int *latch);
+T_RC LatchCountDown(int latch);
+T_RC LatchWait(int latch);
+T_RC LatchDestroy(int latch);
+void *LatchWaitable(int latch, bool *ready);
+T_RC SemCreate(uval32 count, int *sem);
+T_RC SemPost(int sem);
+T_RC SemWait(int sem);
+T_RC SemDestroy(int sem);
+void *SemWaitable(int sem, bool *ready);
+
+#endif
@@ -0,0 +1,133 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "user.h"
+#include "clock.h"
+#include "kinfo.h"
+#include "syncbench.h"
+
+#ifndef NATIVE
+
+#include <stdio.h>
+
+// Threads never run on x86, so each step below is taken by whichever 
+// participant the kernel made Active, as in WorkloadRun().
+
+static ThreadId Tids[SYNCBENCH_MAX];
+
+static double Ns(uval32 clocks, uval32 per)
+{
+  return 1e9 * clocks / CLOCK_HZ / per;
+}
+
+static void Spawn(uval32 n)
+{
+  uval32 i;
+
+  for (i = 0; i < n; i++) {
+    SysCall(SYS_CREATE, (uvalptr) SyncBench, STACKSIZE, SYNCBENCH_PRIORITY);
+  }
+}
+
+static void Reap(uval32 n)
+{
+  uval32 i;
+
+  for (i = 0; i < n; i++) {
+    SysCall(SYS_DIST, Tids[i], 0, 0);
+  }
+}
+
+// Each phase is n arrivals; the last one releases the other n - 1.
+static void BarrierPhases(uval32 n, uval32 rounds, uval32 *phase, 
+			  uval32 *release)
+{
+  uval32 start, t;
+  uval32 r, i;
+  int barrier;
+
+  SysCall(SYS_BARRIER_CREATE, n, (uvalptr) &barrier, 0);
+  *release = 0;
+
+  start = ReadClock();
+  for (r = 0; r < rounds; r++) {
+    for (i = 0; i < n; i++) {
+      if (r == 0) {
+	Tids[i] = GetTid();
+      }
+      t = ReadClock();
+      SysCall(SYS_BARRIER_WAIT, barrier, 0, 0);
+      if (i == n - 1) {
+	*release += ReadClock() - t;
+      }
+    }
+  }
+  *phase = ReadClock() - start;
+
+  SysCall(SYS_BARRIER_DESTROY, barrier, 0, 0);
+}
+
+// Each thread bumps a shared counter, then yields until the count is 
+// complete. The phase ends once every thread has seen it complete.
+static void SpinPhases(uval32 n, uval32 rounds, uval32 *phase, 
+		       uval32 *yields)
+{
+  static bool arrived[NUM_TID + 1];
+  static bool seen[NUM_TID + 1];
+  uval32 counter, done;
+  uval32 start;
+  uval32 r, i;
+  ThreadId tid;
+
+  *yields = 0;
+  start = ReadClock();
+  for (r = 0; r < rounds; r++) {
+    counter = 0;
+    done = 0;
+    for (i = 0; i < n; i++) {
+      arrived[Tids[i]] = seen[Tids[i]] = FALSE;
+    }
+
+    while (done < n) {
+      tid = GetTid();
+      if (!arrived[tid]) {
+	arrived[tid] = TRUE;
+	counter++;
+      } else if (counter == n && !seen[tid]) {
+	seen[tid] = TRUE;
+	done++;
+	if (done == n) {
+	  break;
+	}
+      }
+      SysCall(SYS_YIELD, 0, 0, 0);
+      (*yields)++;
+    }
+  }
+  *phase = ReadClock() - start;
+}
+
+int SyncBench(uval32 rounds)
+{
+  uval32 phase, release, spin, yields;
+  uval32 n;
+
+  if (rounds == 0) {
+    rounds = 100;
+  }
+
+  printf("threads  barrier ns/phase  release ns  spin ns/phase  "
+	 "spin yields/phase\n");
+  for (n = 2; n <= SYNCBENCH_MAX; n *= 2) {
+    Spawn(n);
+    BarrierPhases(n, rounds, &phase, &release);
+    SpinPhases(n, rounds, &spin, &yields);
+    Reap(n);
+
+    printf("%7u %17.0f %11.0f %14.0f %18u\n", n, Ns(phase, rounds), 
+	   Ns(release, rounds), Ns(spin, rounds), yields / rounds);
+  }
+  return 0;
+}
+
+#endif /* NATIVE */
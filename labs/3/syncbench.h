@@ -0,0 +1,19 @@
+#ifndef _SYNCBENCH_H_
+#define _SYNCBENCH_H_
+
+#include "defines.h"
+
+// Barrier phase transition benchmark, x86 build only. With 
+// KSYNCBENCH=<rounds> in the environment prog runs groups of 2 to 
+// SYNCBENCH_MAX threads through <rounds> phases each, once with a kernel
+// barrier and once with the old shared counter and Yield() loop, and 
+// prints the cost of a phase and of releasing it.
+#define SYNCBENCH_ENV "KSYNCBENCH"
+#define SYNCBENCH_MAX 256
+#define SYNCBENCH_PRIORITY 10
+
+#ifndef NATIVE
+int SyncBench(uval32 rounds);
+#endif /* NATIVE */
+
+#endif
@@ -0,0 +1,157 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "clock.h"
+#include "sched.h"
+#include "workload.h"
+#include "tdbench.h"
+
+#ifndef NATIVE
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// Set by the walks so the compiler cannot drop the loads.
+static volatile uval32 Sink;
+// One flag per cache line of TD_TABLE and TD_COLD, for counting the 
+// lines a walk touches.
+static bool Touched[(sizeof(TD_TABLE) + sizeof(TD_COLD)) / TDBENCH_LINE + 2];
+
+// The hardware L1 data cache read miss counter, or -1 if there is none.
+static int OpenMisses(void)
+{
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_L1D | 
+    (PERF_COUNT_HW_CACHE_OP_READ << 8) | 
+    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void Mark(void *p, void *base, int offset)
+{
+  Touched[offset + ((char *) p - (char *) base) / TDBENCH_LINE] = TRUE;
+}
+
+// Walks the ready queue as PriorityEnqueue() does, also reading the 
+// saved registers if cold. Counts the lines it touches if count.
+static uval32 Walk(bool cold, bool count)
+{
+  int offset = sizeof(TD_TABLE) / TDBENCH_LINE + 1;
+  uval32 sum = 0;
+  TD *td;
+
+  for (td = ReadyQ->head; td; td = td->link) {
+    sum += td->priority;
+    if (cold) {
+      sum += td->cold->regs.pc;
+    }
+    if (count) {
+      Mark(&td->link, TD_TABLE, 0);
+      Mark(&td->priority, TD_TABLE, 0);
+      if (cold) {
+	Mark(&td->cold->regs.pc, TD_COLD, offset);
+      }
+    }
+  }
+  return sum;
+}
+
+static int Lines(void)
+{
+  int i, n = 0;
+
+  for (i = 0; i < sizeof(Touched) / sizeof(Touched[0]); i++) {
+    n += Touched[i];
+    Touched[i] = FALSE;
+  }
+  return n;
+}
+
+static void Report(char *what, uval32 rounds, uval32 spent, int lines, 
+		   int misses, long long count)
+{
+  printf("%-24s %10.0f", what, spent * (1e9 / CLOCK_HZ) / rounds);
+  if (lines >= 0) {
+    printf(" %8d", lines);
+  } else {
+    printf(" %8s", "-");
+  }
+  if (misses >= 0) {
+    printf(" %12.1f\n", (double) count / rounds);
+  } else {
+    printf(" %12s\n", "n/a");
+  }
+}
+
+int TdBench(uval32 rounds)
+{
+  uval32 start, spent;
+  long long count = 0;
+  int i, n = 0, misses, lines;
+  bool cold;
+
+  if (Sched != &ListPolicy) {
+    printf("the ready queue walk needs the list policy\n");
+    return 1;
+  }
+  while (CreateThread((uval32) (uvalptr) WorkloadNop, STACKSIZE, 
+		      TDBENCH_PRIORITY) > OK) {
+    n++;
+  }
+  misses = OpenMisses();
+
+  printf("%d ready threads, TD %d bytes, TDCold %d bytes\n", n, 
+	 (int) sizeof(TD), (int) sizeof(TDCold));
+  printf("%-24s %10s %8s %12s\n", "", "ns", "lines", "L1D misses");
+
+  for (cold = FALSE; cold <= TRUE; cold++) {
+    Walk(cold, TRUE);
+    lines = Lines();
+
+    if (misses >= 0) {
+      ioctl(misses, PERF_EVENT_IOC_RESET, 0);
+      ioctl(misses, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    start = ReadClock();
+    for (i = 0; i < rounds; i++) {
+      Sink = Walk(cold, FALSE);
+    }
+    spent = ReadClock() - start;
+    if (misses >= 0) {
+      ioctl(misses, PERF_EVENT_IOC_DISABLE, 0);
+      read(misses, &count, sizeof(count));
+    }
+    Report(cold ? "walk, hot and cold" : "walk, hot fields", rounds, spent,
+	   lines, misses, count);
+  }
+
+  if (misses >= 0) {
+    ioctl(misses, PERF_EVENT_IOC_RESET, 0);
+    ioctl(misses, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  start = ReadClock();
+  for (i = 0; i < rounds; i++) {
+    Yield();
+  }
+  spent = ReadClock() - start;
+  if (misses >= 0) {
+    ioctl(misses, PERF_EVENT_IOC_DISABLE, 0);
+    read(misses, &count, sizeof(count));
+    close(misses);
+  }
+  Report("Yield, scan and dispatch", rounds, spent, -1, misses, count);
+
+  return 0;
+}
+
+#endif /* NATIVE */
@@ -0,0 +1,22 @@
+#ifndef _TDBENCH_H_
+#define _TDBENCH_H_
+
+#include "defines.h"
+
+// Thread descriptor layout benchmark, x86 build only. With 
+// KTDBENCH=<rounds> in the environment prog fills every free tid with a 
+// ready thread of the same priority and times <rounds> of: a walk of the
+// ready queue reading only the hot TD fields, the same walk also reading 
+// the saved registers as it had to before the hot/cold split, and a 
+// Yield(), which scans the whole queue to requeue Active and dispatches 
+// the next thread. It prints the cache lines each walk touches and, where
+// the host lets it, the L1 data cache misses counted by the processor.
+#define TDBENCH_ENV "KTDBENCH"
+#define TDBENCH_PRIORITY 64
+#define TDBENCH_LINE 64
+
+#ifndef NATIVE
+int TdBench(uval32 rounds);
+#endif /* NATIVE */
+
+#endif
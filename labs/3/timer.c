@@ -0,0 +1,289 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "user.h"
+#include "clock.h"
+#include "timer.h"
+#include "waitq.h"
+
+static Timer Timers[MAX_TIMERS];
+static Timer *FreeTimers;
+static Timer *Wheel[TIMER_WHEEL_SLOTS];
+
+// Callbacks due, oldest at CallHead. The service thread waits on Calls.
+static TimerCall Calls[TIMER_QUEUE_SIZE];
+static int CallHead;
+static int CallCount;
+static TD *Service;
+
+void InitTimers(void)
+{
+  int i;
+
+  FreeTimers = NULL;
+  for (i = MAX_TIMERS - 1; i >= 0; i--) {
+    Timers[i].used = FALSE;
+    Timers[i].generation = 0;
+    Timers[i].next = FreeTimers;
+    FreeTimers = &Timers[i];
+  }
+  for (i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+    Wheel[i] = NULL;
+  }
+  CallHead = 0;
+  CallCount = 0;
+  Service = NULL;
+}
+
+static void Arm(Timer *t)
+{
+  Timer **slot = &Wheel[t->expires & (TIMER_WHEEL_SLOTS - 1)];
+
+  t->prev = NULL;
+  t->next = *slot;
+  if (*slot) {
+    (*slot)->prev = t;
+  }
+  *slot = t;
+  t->armed = TRUE;
+}
+
+static void Disarm(Timer *t)
+{
+  if (t->prev) {
+    t->prev->next = t->next;
+  } else {
+    Wheel[t->expires & (TIMER_WHEEL_SLOTS - 1)] = t->next;
+  }
+  if (t->next) {
+    t->next->prev = t->prev;
+  }
+  t->armed = FALSE;
+}
+
+static Timer *Lookup(int timer)
+{
+  if ((timer < 0) || (timer >= MAX_TIMERS) || !Timers[timer].used ||
+      Timers[timer].private) {
+    return NULL;
+  }
+  return &Timers[timer];
+}
+
+// Hands t's callback to the service thread, directly if it is waiting.
+static void QueueCall(Timer *t)
+{
+  TD *td;
+  Task *task;
+
+  if (t->queued) {
+    t->overruns++;
+    return;
+  }
+
+  if ((td = WaitqDequeue(Calls)) != NULL) {
+    task = (Task *) td->cold->waitdata;
+    task->fn = t->fn;
+    task->arg = t->arg;
+    td->cold->waitdata = NULL;
+    WakeThread(td);
+  } else if (CallCount < TIMER_QUEUE_SIZE) {
+    Calls[(CallHead + CallCount) % TIMER_QUEUE_SIZE].timer = t;
+    Calls[(CallHead + CallCount) % TIMER_QUEUE_SIZE].generation = t->generation;
+    CallCount++;
+    t->queued = TRUE;
+  } else {
+    t->overruns++;
+  }
+}
+
+static void Fire(Timer *t)
+{
+  if (t->fn) {
+    QueueCall(t);
+  } else if (WakeN(t, 0) == 0) {
+    t->pending++;
+  }
+}
+
+// Creates and arms a timer and stores its id in *timer. The first timer 
+// with a callback starts the service thread.
+T_RC TimerCreate(TimerSpec *spec, int *timer)
+{
+  Timer *t;
+  T_RC rc;
+
+  if (spec->delay == 0) {
+    return FAILED;
+  } else if (!FreeTimers) {
+    return RESOURCE_ERROR;
+  }
+
+  if (spec->fn && !Service) {
+    if ((rc = AllocThread((uval32) (uvalptr) TimerService, 
+			  TIMER_SERVICE_PRIORITY, &Service)) != OK) {
+      Service = NULL;
+      return rc;
+    }
+    MakeReady(Service);
+  }
+
+  t = FreeTimers;
+  FreeTimers = t->next;
+
+  t->used = TRUE;
+  t->private = FALSE;
+  t->expires = Ticks + spec->delay;
+  t->period = spec->period;
+  t->fn = spec->fn;
+  t->arg = spec->arg;
+  t->pending = 0;
+  t->overruns = 0;
+  t->queued = FALSE;
+  t->generation++;
+  Arm(t);
+
+  *timer = t - Timers;
+  return OK;
+}
+
+// Disarms and frees a timer. Threads waiting on it are woken. A callback
+// still in the service queue does not run, but one already handed to the
+// service thread does.
+T_RC TimerCancel(int timer)
+{
+  Timer *t;
+
+  if ((t = Lookup(timer)) == NULL) {
+    return FAILED;
+  }
+
+  WakeN(t, 0);
+  TimeoutStop(t);
+  return OK;
+}
+
+// Blocks until the timer next expires, unless it has expired since the 
+// last wait. Fails for a timer with a callback, whose expiries go to the
+// callback and never wake anyone.
+T_RC TimerWait(int timer)
+{
+  Timer *t;
+
+  if ((t = Lookup(timer)) == NULL || t->fn) {
+    return FAILED;
+  }
+
+  if (t->pending > 0) {
+    t->pending--;
+    return OK;
+  }
+  return WaitOn(t);
+}
+
+// For SYS_WAIT_ANY: returns the object to wait on for the timer's next 
+// expiry, or null if there is no such timer or it has a callback. Sets 
+// *ready, if given, taking the expiry, if it has expired since the last
+// wait.
+void *TimerWaitable(int timer, bool *ready)
+{
+  Timer *t;
+
+  if ((t = Lookup(timer)) == NULL || t->fn) {
+    return NULL;
+  }
+
+  if (ready && (*ready = t->pending > 0)) {
+    t->pending--;
+  }
+  return t;
+}
+
+// Arms a private one-shot timer for a wait that gives up after ticks. 
+// Returns null if there is no free timer. The waker frees it, so the 
+// timer calls must not find it by id: cancelling it would free it twice.
+Timer *TimeoutStart(uval32 ticks)
+{
+  TimerSpec spec = { ticks, 0, NULL, NULL };
+  int id;
+
+  if (TimerCreate(&spec, &id) != OK) {
+    return NULL;
+  }
+  Timers[id].private = TRUE;
+  return &Timers[id];
+}
+
+// Frees a timer from TimeoutStart(), whether or not it expired.
+void TimeoutStop(Timer *t)
+{
+  if (t->armed) {
+    Disarm(t);
+  }
+  t->used = FALSE;
+  t->generation++;
+  t->next = FreeTimers;
+  FreeTimers = t;
+}
+
+// SYS_TIMER_NEXT: stores the next due callback in *task, blocking the 
+// service thread until there is one.
+T_RC TimerNext(Task *task)
+{
+  TimerCall *call;
+
+  while (CallCount > 0) {
+    call = &Calls[CallHead];
+    CallHead = (CallHead + 1) % TIMER_QUEUE_SIZE;
+    CallCount--;
+
+    // Skip callbacks of timers cancelled since.
+    if (call->timer->generation == call->generation) {
+      call->timer->queued = FALSE;
+      task->fn = call->timer->fn;
+      task->arg = call->timer->arg;
+      return OK;
+    }
+  }
+
+  Active->cold->waitdata = task;
+  return WaitOn(Calls);
+}
+
+// Called from ClockIsr() after Ticks has advanced. Expires the timers of
+// this tick's slot that are due; the others in it are a lap or more 
+// away.
+void TimerTick(void)
+{
+  Timer *t, *next;
+
+  for (t = Wheel[Ticks & (TIMER_WHEEL_SLOTS - 1)]; t; t = next) {
+    next = t->next;
+    if ((int) (t->expires - Ticks) > 0) {
+      continue;
+    }
+
+    Disarm(t);
+    if (t->period) {
+      // Keep to the original schedule, skipping expiries already missed.
+      t->expires += t->period;
+      while ((int) (t->expires - Ticks) <= 0) {
+	t->expires += t->period;
+	t->overruns++;
+      }
+      Arm(t);
+    }
+    Fire(t);
+  }
+}
+
+// Runs timer callbacks, one at a time.
+void TimerService(void)
+{
+  Task task;
+
+  while (1) {
+    SysCall(SYS_TIMER_NEXT, (uvalptr) &task, 0, 0);
+    task.fn(task.arg);
+  }
+}
@@ -0,0 +1,85 @@
+#ifndef _TIMER_H_
+#define _TIMER_H_
+
+#include "defines.h"
+#include "list.h"
+#include "pool.h"
+
+// One-shot and periodic timers, in ticks. Armed timers hang in a timing 
+// wheel slot chosen by their absolute expiry tick, so arming and 
+// cancelling cost O(1) however many timers there are. Each tick walks 
+// only its own slot, which holds about 1 / TIMER_WHEEL_SLOTS of the armed
+// timers when their expiries are spread out, and all of them when they 
+// are a multiple of TIMER_WHEEL_SLOTS ticks apart. A periodic timer's 
+// next expiry is its last one plus the period, never "now plus the 
+// period", so it does not drift.
+//
+// A timer with a callback has it run by the timer service thread; one 
+// without wakes the threads blocked in SYS_TIMER_WAIT on it, or is 
+// remembered for the next wait if there are none.
+#define MAX_TIMERS 256
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+
+// Callbacks that can be waiting for the service thread.
+#define TIMER_QUEUE_SIZE 64
+#define TIMER_SERVICE_PRIORITY 2
+
+typedef struct type_TIMER Timer;
+typedef struct type_TIMER_SPEC TimerSpec;
+typedef struct type_TIMER_CALL TimerCall;
+
+struct type_TIMER
+{
+  // Neighbours in the wheel slot, or next in the free list.
+  Timer *next;
+  Timer *prev;
+  bool used;
+  bool armed;
+  // From TimeoutStart(): owned by one wait, not reachable by id.
+  bool private;
+  // Absolute tick of the next expiry.
+  uval32 expires;
+  // 0 for one-shot.
+  uval32 period;
+  TaskFn fn;
+  void *arg;
+  // Expiries no waiter has seen yet.
+  uval32 pending;
+  // Expiries lost because the callback or tick was late.
+  uval32 overruns;
+  // Callback is in the service queue.
+  bool queued;
+  // Tells a reused descriptor from the timer that queued a callback.
+  uval32 generation;
+};
+
+// Passed to SYS_TIMER_CREATE.
+struct type_TIMER_SPEC
+{
+  // Ticks until the first expiry, at least 1.
+  uval32 delay;
+  uval32 period;
+  // NULL to wake waiters instead.
+  TaskFn fn;
+  void *arg;
+};
+
+struct type_TIMER_CALL
+{
+  Timer *timer;
+  uval32 generation;
+};
+
+void InitTimers(void);
+T_RC TimerCreate(TimerSpec *spec, int *timer);
+T_RC TimerCancel(int timer);
+T_RC TimerWait(int timer);
+T_RC TimerNext(Task *task);
+void *TimerWaitable(int timer, bool *ready);
+Timer *TimeoutStart(uval32 ticks);
+void TimeoutStop(Timer *t);
+void TimerTick(void);
+void TimerService(void);
+
+#endif
@@ -0,0 +1,275 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "trace.h"
+
+#ifndef NATIVE
+
+#include "io.h"
+#include "clock.h"
+#include "lcd.h"
+#include "edf.h"
+#include "fair.h"
+#include "ltask.h"
+#include "sched.h"
+#include "timer.h"
+#include "waitset.h"
+#include "cluster.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+FILE *TraceFile;
+
+typedef struct type_TRACE_STAT TraceStat;
+
+// Replay cost of one system call type, in nanoseconds.
+struct type_TRACE_STAT
+{
+  uval32 calls;
+  unsigned long long total;
+  unsigned long long max;
+};
+
+// Pointer arguments of a system call: which one the kernel reads and how
+// much, and which one it writes to, possibly only when the caller is 
+// woken. -1 for none.
+typedef struct type_TRACE_ARGS TraceArgs;
+
+struct type_TRACE_ARGS
+{
+  int in;
+  int size;
+  int out;
+};
+
+static TraceArgs ArgsOf(SysCallType type)
+{
+  TraceArgs a = { -1, 0, -1 };
+
+  switch (type) {
+  case SYS_BUTTON_WAIT:
+  case SYS_LCD_WAIT:
+  case SYS_POOL_WAIT:
+  case SYS_TIMER_NEXT:
+  case SYS_HEAP_STATS:
+  case SYS_MSG_RECV:
+  case SYS_GROUP_CREATE:
+    a.out = 0;
+    break;
+  case SYS_LCD_POST:
+    a.in = 0;
+    a.size = sizeof(LcdMsg);
+    break;
+  case SYS_CREATE_EDF:
+    a.in = 1;
+    a.size = sizeof(EdfParams);
+    break;
+  case SYS_POOL_CREATE:
+  case SYS_WAKE:
+    a.out = 2;
+    break;
+  case SYS_LTASK_CREATE:
+    a.in = 0;
+    a.size = sizeof(LTaskSpec);
+    a.out = 1;
+    break;
+  case SYS_TIMER_CREATE:
+    a.in = 0;
+    a.size = sizeof(TimerSpec);
+    a.out = 1;
+    break;
+  case SYS_MSG_SEND:
+    a.in = 0;
+    a.size = sizeof(ClusterMsg);
+    a.out = 1;
+    break;
+  case SYS_WAIT_ANY:
+    a.in = 0;
+    a.size = sizeof(WaitSet);
+    break;
+  case SYS_LTASK_NEXT:
+  case SYS_KINFO:
+  case SYS_BARRIER_CREATE:
+  case SYS_LATCH_CREATE:
+  case SYS_SEM_CREATE:
+  case SYS_HEAP_ALLOC:
+    a.out = 1;
+    break;
+  default:
+    break;
+  }
+  return a;
+}
+
+void TraceStart(char *path)
+{
+  if (path) {
+    TraceFile = fopen(path, "wb");
+  }
+}
+
+void TraceStop(void)
+{
+  if (TraceFile) {
+    fclose(TraceFile);
+    TraceFile = NULL;
+  }
+}
+
+// Appends one call to the trace. Flushed every time, since prog is 
+// normally stopped by killing it.
+void TraceRecord(SysCallType type, uvalptr arg0, uvalptr arg1, uvalptr arg2)
+{
+  TraceArgs a = ArgsOf(type);
+  TraceRec rec;
+
+  rec.type = type;
+  rec.size = a.size;
+  rec.tid = Active->tid;
+  rec.tick = Ticks;
+  rec.arg[0] = arg0;
+  rec.arg[1] = arg1;
+  rec.arg[2] = arg2;
+
+  fwrite(&rec, sizeof(rec), 1, TraceFile);
+  if (a.in >= 0) {
+    fwrite((void *) rec.arg[a.in], a.size, 1, TraceFile);
+  }
+  fflush(TraceFile);
+}
+
+// Makes tid the Active thread, as it was when the call was recorded. 
+// Fails if it is not ready, i.e. the replay has diverged.
+static bool SwitchTo(ThreadId tid)
+{
+  TD *td;
+
+  if (Active->tid == tid) {
+    return TRUE;
+  }
+  if (!tidInUse(tid)) {
+    return FALSE;
+  }
+
+  td = getTD(tid);
+  if (td->inlist == ReadyQ) {
+    Sched->remove(td);
+  } else if (td->inlist == EdfQ) {
+    Dequeue(td, EdfQ);
+  } else if (td->inlist == FairQ) {
+    FairRemove(td);
+  } else {
+    return FALSE;
+  }
+  td->inlist = NULL;
+
+  MakeReady(Active);
+  Active = td;
+  return TRUE;
+}
+
+static unsigned long long Nanoseconds(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long long) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void PrintStats(TraceStat *stats, uval32 diverged)
+{
+  unsigned long long total = 0;
+  uval32 calls = 0;
+  int t;
+
+  printf("type    calls     avg ns     max ns\n");
+  for (t = 0; t < 256; t++) {
+    if (stats[t].calls == 0) {
+      continue;
+    }
+    printf("%4d %8u %10llu %10llu\n", t, stats[t].calls,
+	   stats[t].total / stats[t].calls, stats[t].max);
+    total += stats[t].total;
+    calls += stats[t].calls;
+  }
+  printf("%u calls, %llu ns in the kernel, %u diverged\n", calls, total, 
+	 diverged);
+}
+
+// Replays the trace at path. Expects a freshly initialized kernel. Timer 
+// ticks are replayed between calls so that tick driven scheduling sees 
+// the same time; pointer arguments point at a copy of the recorded 
+// payload or at a scratch area.
+int TraceReplay(char *path)
+{
+  static uval8 payload[TRACE_MAX_PAYLOAD];
+  static uvalptr scratch[TRACE_MAX_PAYLOAD / sizeof(uvalptr)];
+  // SYS_WAIT_ANY keeps a pointer into its set for as long as the thread 
+  // waits, so each thread gets a copy payload is not reused for.
+  static WaitSet sets[NUM_TID + 1];
+  static TraceStat stats[256];
+  unsigned long long start, spent;
+  uval32 diverged = 0;
+  TraceArgs a;
+  TraceRec rec;
+  FILE *in;
+
+  in = fopen(path, "rb");
+  if (!in) {
+    perror(path);
+    return 1;
+  }
+
+  while (fread(&rec, sizeof(rec), 1, in) == 1) {
+    if (rec.size > TRACE_MAX_PAYLOAD ||
+	fread(payload, 1, rec.size, in) != rec.size) {
+      printf("%s: corrupt record\n", path);
+      break;
+    }
+
+    while (Ticks < rec.tick) {
+      TIMER_STATUS = TIMER_TO;
+      ClockIsr(0);
+    }
+
+    if (!SwitchTo(rec.tid)) {
+      diverged++;
+      continue;
+    }
+
+    // The block and the lock belong to the recorded run, not this one.
+    if (rec.type == SYS_HEAP_FREE || rec.type == SYS_RW_READ ||
+	rec.type == SYS_RW_WRITE || rec.type == SYS_RW_UNLOCK) {
+      continue;
+    }
+
+    a = ArgsOf(rec.type);
+    if (rec.type == SYS_WAIT_ANY) {
+      memcpy(&sets[rec.tid], payload, sizeof(WaitSet));
+      rec.arg[a.in] = (uvalptr) &sets[rec.tid];
+    } else if (a.in >= 0) {
+      rec.arg[a.in] = (uvalptr) payload;
+    }
+    if (a.out >= 0) {
+      rec.arg[a.out] = (uvalptr) scratch;
+    }
+
+    start = Nanoseconds();
+    K_SysCall(rec.type, rec.arg[0], rec.arg[1], rec.arg[2]);
+    spent = Nanoseconds() - start;
+
+    stats[rec.type].calls++;
+    stats[rec.type].total += spent;
+    if (spent > stats[rec.type].max) {
+      stats[rec.type].max = spent;
+    }
+  }
+
+  fclose(in);
+  PrintStats(stats, diverged);
+  return 0;
+}
+
+#endif /* NATIVE */
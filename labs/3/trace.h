@@ -0,0 +1,50 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include "defines.h"
+
+// System call trace, host build only. With KTRACE=<file> in the 
+// environment every K_SysCall is appended to <file>; with 
+// KREPLAY=<file> prog feeds a recorded trace into a fresh kernel instead
+// of running mymain, and reports what each call cost.
+#define TRACE_ENV "KTRACE"
+#define REPLAY_ENV "KREPLAY"
+
+// Largest argument block a system call reads through a pointer.
+#define TRACE_MAX_PAYLOAD 256
+
+typedef struct type_TRACE_REC TraceRec;
+
+// One record, followed by size bytes of payload: a copy of the structure
+// the call reads through a pointer argument, if any.
+struct type_TRACE_REC
+{
+  uval16 type;
+  // Up to TRACE_MAX_PAYLOAD, which does not fit in a byte.
+  uval16 size;
+  ThreadId tid;
+  uval32 tick;
+  uvalptr arg[3];
+};
+
+#ifndef NATIVE
+
+#include <stdio.h>
+
+extern FILE *TraceFile;
+
+#define TRACE_SYSCALL(type, arg0, arg1, arg2) \
+  if (TraceFile) TraceRecord(type, arg0, arg1, arg2)
+
+void TraceStart(char *path);
+void TraceStop(void);
+void TraceRecord(SysCallType type, uvalptr arg0, uvalptr arg1, uvalptr arg2);
+int TraceReplay(char *path);
+
+#else /* NATIVE */
+
+#define TRACE_SYSCALL(type, arg0, arg1, arg2)
+
+#endif /* NATIVE */
+
+#endif
@@ -2,6 +2,10 @@
 #include "list.h"
 #include "user.h"
 #include "main.h"
+#include "lcd.h"
+#include "clock.h"
+#include "kinfo.h"
+#include "workload.h"
 
 #ifndef NATIVE
 
@@ -10,43 +14,159 @@
 #endif /* NATIVE */
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
-RC SysCall(SysCallType type, uval32 arg0, uval32 arg1, uval32 arg2) 
+// Returns what the kernel did: OK or a negative T_RC error, or a value 
+// such as a tid for the calls that have one.
+sval32 SysCall(SysCallType type, uvalptr arg0, uvalptr arg1, uvalptr arg2) 
 {
-  uval32 returnCode;
+  sval32 returnCode;
 
 #ifdef NATIVE  
-  uval32 sysMode = SYS_ENTER;  
-
   // Save context on stack. This is already done in the isr.
 
-  // Load arguments, execute software trap to kernel.
-  asm volatile("ldw r8, %0\n\t"
-	       "ldw r4, %1\n\t" 
+  // Load arguments, execute software trap to kernel. The kernel leaves 
+  // the result in r2.
+  asm volatile("ldw r4, %1\n\t" 
 	       "ldw r5, %2\n\t"
 	       "ldw r6, %3\n\t"
 	       "ldw r7, %4\n\t" 
-	       "trap"
-	       : : "m" (sysMode), "m" (type), "m" (arg0), "m" (arg1), "m" (arg2)
-	       : "r4", "r5", "r6", "r7", "r8");  
+	       "trap\n\t"
+	       "stw r2, %0"
+	       : "=m" (returnCode) 
+	       : "m" (type), "m" (arg0), "m" (arg1), "m" (arg2)
+	       : "r2", "r4", "r5", "r6", "r7");  
 #else /* NATIVE */
-  myprint("Here\n");
-  CreateThread(arg0, arg1, arg2); //Kernel system call - not normally accessible from user space
+  returnCode = K_SysCall(type, arg0, arg1, arg2); //Kernel system call - not normally accessible from user space
 #endif /* NATIVE */
   
-  returnCode = RC_SUCCESS; //Change this code to take the actual return value
   return returnCode; 
 } 
 
+// Lab 2's "Hello World!" on the LCD, driven by pushbutton events instead
+// of polling: the first press shows "Hello ", the second adds "World!".
+void ButtonDemo() 
+{
+  uval32 event;
+  LcdMsg msg;
+  int first_button_pressed = 0;
+
+  while(1) {
+    SysCall(SYS_BUTTON_WAIT, (uvalptr) &event, 0, 0);
+
+    if (!first_button_pressed) {
+      msg.line = 0;
+      msg.clear = 1;
+      strcpy(msg.text, "Hello ");
+    } else {
+      msg.line = 1;
+      msg.clear = 0;
+      strcpy(msg.text, "World!");
+    }
+    first_button_pressed = !first_button_pressed;
+
+    SysCall(SYS_LCD_POST, (uvalptr) &msg, 0, 0);
+  }
+}
+
+// Compares asking for the tid through a trap with reading it from the 
+// kernel data page, and prints the cost of KINFO_BENCH_RUNS of each in 
+// ReadClock() units; one is often under a unit on x86. With 
+// SYSCALL_TIMING it also prints how much of the trap is spent getting 
+// into K_SysCall() and how much getting back out.
+void KInfoBench()
+{
+  uval32 start, trap, page;
+  uval32 tid;
+  int i;
+#ifdef SYSCALL_TIMING
+  uval32 clock, before, enter = 0, leave = 0;
+
+  // What the ReadClock() calls cost, taken off both halves. One reading 
+  // is too coarse, so time as many as the loop below makes per half.
+  start = ReadClock();
+  for (i = 0; i < KINFO_BENCH_RUNS; i++) {
+    ReadClock();
+  }
+  clock = ReadClock() - start;
+  for (i = 0; i < KINFO_BENCH_RUNS; i++) {
+    before = ReadClock();
+    SysCall(SYS_KINFO, KINFO_TID, (uvalptr) &tid, 0);
+    leave += ReadClock() - KernelInfo->sysExit;
+    enter += KernelInfo->sysEnter - before;
+  }
+  leave = leave > clock ? leave - clock : 0;
+  enter = enter > clock ? enter - clock : 0;
+#endif /* SYSCALL_TIMING */
+
+  start = ReadClock();
+  for (i = 0; i < KINFO_BENCH_RUNS; i++) {
+    SysCall(SYS_KINFO, KINFO_TID, (uvalptr) &tid, 0);
+  }
+  trap = ReadClock() - start;
+
+  start = ReadClock();
+  for (i = 0; i < KINFO_BENCH_RUNS; i++) {
+    tid = GetTid();
+  }
+  page = ReadClock() - start;
+
+  myprint("KInfoBench runs ");
+  printHex(KINFO_BENCH_RUNS);
+  myprint(" trap ");
+  printHex(trap);
+  myprint(" page ");
+  printHex(page);
+#ifdef SYSCALL_TIMING
+  myprint(" enter ");
+  printHex(enter);
+  myprint(" exit ");
+  printHex(leave);
+#endif /* SYSCALL_TIMING */
+  myprint("\n");
+
+  SysCall(SYS_DIST, 0, 0, 0);
+}
+
+// Starts the demo threads and a synthetic workload. On x86 the workload
+// can be configured through $WORKLOAD, see workload.h, and is played by 
+// WorkloadRun().
 void mymain() 
 { 
-  RC ret;
+  WorkloadConfig config;
+  sval32 ret;
 
-  ret = SysCall(SYS_CREATE, 0x1234, 0, 0); 
-  assert(ret == RC_SUCCESS);
-  
+  ret = SysCall(SYS_CREATE, (uvalptr) LcdDriver, STACKSIZE, 2); 
+  assert(ret > OK);
+
+  ret = SysCall(SYS_CREATE, (uvalptr) ButtonDemo, STACKSIZE, 3); 
+  assert(ret > OK);
+
+#if defined(NATIVE) && defined(KINFO_BENCH)
+  ret = SysCall(SYS_CREATE, (uvalptr) KInfoBench, STACKSIZE, 100); 
+  assert(ret > OK);
+#endif /* NATIVE && KINFO_BENCH */
+
+  memset(&config, 0, sizeof(config));
+  WorkloadParse(WORKLOAD_DEFAULT, &config);
+#ifndef NATIVE
+  if (getenv("WORKLOAD") && WorkloadParse(getenv("WORKLOAD"), &config) != OK) {
+    myprint("bad WORKLOAD\n");
+    return;
+  }
+#endif /* NATIVE */
+  if (WorkloadStart(&config) != OK) {
+    myprint("bad workload config\n");
+    return;
+  }
+
+#ifndef NATIVE
+  WorkloadRun();
+  myprint("DONE\n");
+#else /* NATIVE */
   myprint("DONE\n");
 
   while(1);
+#endif /* NATIVE */
 }
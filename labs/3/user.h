@@ -3,8 +3,16 @@
 
 #include "defines.h"
 
-RC SysCall( SysCallType type, uval32 arg0, uval32 arg1, uval32 arg2);
+sval32 SysCall( SysCallType type, uvalptr arg0, uvalptr arg1, uvalptr arg2);
 
+// Calls per measurement in KInfoBench(). On x86 it runs instead of 
+// mymain with KKINFOBENCH=1 in the environment; on the board, build with
+// -DKINFO_BENCH to have mymain start it.
+#define KINFO_BENCH_RUNS 1000
+#define KINFOBENCH_ENV "KKINFOBENCH"
+
+void ButtonDemo(void);
+void KInfoBench(void);
 void mymain(void);
 
 #endif
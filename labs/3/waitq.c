@@ -0,0 +1,341 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "waitq.h"
+#include "timer.h"
+#include "sched.h"
+#include "latency.h"
+
+#include <stdlib.h>
+
+LL* WaitQ;
+
+static WaitNode *Buckets[WAITQ_BUCKETS];
+// Last node of each bucket, so that threads of equal priority piling up 
+// on one object, as at a barrier, are appended without a walk.
+static WaitNode *Tails[WAITQ_BUCKETS];
+
+// Fibonacci hashing of the object's address.
+static int Hash(void *obj)
+{
+  return ((uval32) ((uvalptr) obj >> 2) * 2654435761u) >> (32 - WAITQ_BITS);
+}
+
+static WaitNode **Bucket(void *obj)
+{
+  return &Buckets[Hash(obj)];
+}
+
+// Links node into its object's bucket behind all waiters of higher or 
+// equal priority.
+static void Insert(WaitNode *node)
+{
+  int bucket = Hash(node->obj);
+  WaitNode **ptr = &Buckets[bucket];
+  WaitNode *prev = NULL;
+
+  if (Tails[bucket] && Tails[bucket]->td->priority <= node->td->priority) {
+    prev = Tails[bucket];
+    ptr = &prev->next;
+  } else {
+    while (*ptr && (*ptr)->td->priority <= node->td->priority) {
+      prev = *ptr;
+      ptr = &(*ptr)->next;
+    }
+  }
+
+  node->next = *ptr;
+  node->prev = prev;
+  if (*ptr) {
+    (*ptr)->prev = node;
+  } else {
+    Tails[bucket] = node;
+  }
+  *ptr = node;
+}
+
+static void Unlink(WaitNode *node)
+{
+  int bucket = Hash(node->obj);
+
+  if (node->prev) {
+    node->prev->next = node->next;
+  } else {
+    Buckets[bucket] = node->next;
+  }
+  if (node->next) {
+    node->next->prev = node->prev;
+  } else {
+    Tails[bucket] = node->prev;
+  }
+  node->next = NULL;
+  node->prev = NULL;
+}
+
+void InitWaitq(void)
+{
+  int i;
+
+  WaitQ = CreateList(UNDEF);
+  for (i = 0; i < WAITQ_BUCKETS; i++) {
+    Buckets[i] = NULL;
+    Tails[i] = NULL;
+  }
+}
+
+// Takes the thread of node off every object it waits on, and reports 
+// node as the one that woke it if it asked. *next, if given, is moved 
+// past the nodes unlinked, for callers walking node's bucket.
+static TD *Claim(WaitNode *node, WaitNode **next)
+{
+  TD *td = node->td;
+  TDCold *cold = td->cold;
+  int i;
+
+  for (i = 0; i < cold->nwait; i++) {
+    if (next && *next == &cold->wait[i]) {
+      *next = cold->wait[i].next;
+    }
+    Unlink(&cold->wait[i]);
+  }
+
+  if (cold->ready) {
+    if (cold->timeout && node->obj == cold->timeout) {
+      *cold->ready = 0;
+    } else {
+      *cold->ready = 1 << (node - cold->wait);
+    }
+    cold->ready = NULL;
+  }
+  if (cold->timeout) {
+    TimeoutStop(cold->timeout);
+    cold->timeout = NULL;
+  }
+  cold->nwait = 0;
+  td->inlist = NULL;
+  return td;
+}
+
+// Blocks the Active thread on obj and dispatches the next thread.
+T_RC WaitOn(void *obj)
+{
+  return WaitOnAny(&obj, 1, NULL, NULL);
+}
+
+// Blocks the Active thread on n objects at once until one of them, or 
+// timeout if given, wakes it, and dispatches the next thread. The index 
+// of the object that woke it is stored in *ready as a bit, or 0 for the 
+// timeout. Each object costs one insert into its own bucket, whatever 
+// else is waiting.
+T_RC WaitOnAny(void **objs, int n, uval32 *ready, Timer *timeout)
+{
+  TDCold *cold = Active->cold;
+  int i;
+
+  for (i = 0; i < n; i++) {
+    cold->wait[i].td = Active;
+    cold->wait[i].obj = objs[i];
+    Insert(&cold->wait[i]);
+  }
+  if (timeout) {
+    cold->wait[n].td = Active;
+    cold->wait[n].obj = timeout;
+    Insert(&cold->wait[n]);
+    n++;
+  }
+  cold->nwait = n;
+  cold->ready = ready;
+  cold->timeout = timeout;
+  Active->inlist = WaitQ;
+
+  Dispatch();
+  return OK;
+}
+
+// Makes td, which is on no list and not Active, wait on obj as if it had
+// called WaitOn().
+void WaitqBlock(TD *td, void *obj)
+{
+  TDCold *cold = td->cold;
+
+  cold->wait[0].td = td;
+  cold->wait[0].obj = obj;
+  Insert(&cold->wait[0]);
+  cold->nwait = 1;
+  cold->ready = NULL;
+  cold->timeout = NULL;
+  td->inlist = WaitQ;
+}
+
+// Removes the highest priority thread waiting on obj and returns it, or
+// null if there is none. The thread is on no list afterwards.
+TD *WaitqDequeue(void *obj)
+{
+  WaitNode *node;
+
+  for (node = *Bucket(obj); node; node = node->next) {
+    if (node->obj == obj) {
+      return Claim(node, NULL);
+    }
+  }
+  return NULL;
+}
+
+// Whether any thread waits on obj.
+bool Waited(void *obj)
+{
+  WaitNode *node;
+
+  for (node = *Bucket(obj); node; node = node->next) {
+    if (node->obj == obj) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+// How many threads wait on obj.
+int Waiters(void *obj)
+{
+  WaitNode *node;
+  int n = 0;
+
+  for (node = *Bucket(obj); node; node = node->next) {
+    if (node->obj == obj) {
+      n++;
+    }
+  }
+  return n;
+}
+
+// Wakes the highest priority thread waiting on obj and returns it, or 
+// null if there is none.
+TD *WakeOne(void *obj)
+{
+  TD *td;
+
+  if ((td = WaitqDequeue(obj)) != NULL) {
+    WakeThread(td);
+  }
+  return td;
+}
+
+// Wakes up to n threads waiting on obj, all of them if n is 0, highest 
+// priority first, and returns how many were woken. Priority class 
+// threads go into the ready queue in one Sched->enqueueBatch(), and only
+// then is Active checked once against the most urgent, so a broadcast 
+// costs a single pass over the ready queue and a single scheduling 
+// decision however many it wakes.
+int WakeN(void *obj, int n)
+{
+  static TD *batch[NUM_TID];
+  WaitNode *node, *next;
+  TD *td, *best = NULL;
+  int woken = 0;
+  int queued = 0;
+
+  for (node = *Bucket(obj); node && (n == 0 || woken < n); node = next) {
+    next = node->next;
+    if (node->obj != obj) {
+      continue;
+    }
+
+    td = Claim(node, &next);
+    // Priority class threads go into the ready queue together below.
+    if (td->sched == SCHED_PRIORITY) {
+      LAT_READY(td);
+      batch[queued++] = td;
+    } else {
+      MakeReady(td);
+    }
+    if (!best || RunsBefore(td, best)) {
+      best = td;
+    }
+    woken++;
+  }
+
+  Sched->enqueueBatch(batch, queued);
+
+  if (best && RunsBefore(best, Active)) {
+    NeedResched = TRUE;
+  }
+  return woken;
+}
+
+// SYS_WAIT, SYS_WAKE and WAIT_ADDR take any user address as the key. 
+// They must not reach the kernel objects threads wait on, such as 
+// suspended threads' TDs or barrier and timer table entries, so user keys
+// are complemented into the top half of the address space, where no 
+// kernel object lives. Returns NULL for an address already in the top 
+// half, whose complement could be one.
+void *UserKey(uvalptr addr)
+{
+  if (addr >> (sizeof(uvalptr) * 8 - 1)) {
+    return NULL;
+  }
+  return (void *) ~addr;
+}
+
+// SYS_WAIT: blocks the Active thread on the user address addr.
+T_RC WaitSys(uvalptr addr)
+{
+  void *key = UserKey(addr);
+
+  if (!key) {
+    return FAILED;
+  }
+  return WaitOn(key);
+}
+
+// SYS_WAKE: wakes up to n threads blocked in SYS_WAIT on addr and stores 
+// how many in *woken, if given.
+T_RC WakeSys(uvalptr addr, int n, int *woken)
+{
+  void *key = UserKey(addr);
+  int count;
+
+  if (!key) {
+    return FAILED;
+  }
+  count = WakeN(key, n);
+
+  if (woken) {
+    *woken = count;
+  }
+  return OK;
+}
+
+bool WaitingOn(TD *td, void *obj)
+{
+  int i;
+
+  if (td->inlist != WaitQ) {
+    return FALSE;
+  }
+  for (i = 0; i < td->cold->nwait; i++) {
+    if (td->cold->wait[i].obj == obj) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+// Takes td, which is waiting on some objects, off their wait queues 
+// without waking it.
+void WaitqRemove(TD *td)
+{
+  td->cold->ready = NULL;
+  Claim(&td->cold->wait[0], NULL);
+}
+
+// Moves td, which is waiting on some objects, to its place for its 
+// current priority.
+void WaitqRequeue(TD *td)
+{
+  int i;
+
+  for (i = 0; i < td->cold->nwait; i++) {
+    Unlink(&td->cold->wait[i]);
+    Insert(&td->cold->wait[i]);
+  }
+}
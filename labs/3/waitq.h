@@ -0,0 +1,34 @@
+#ifndef _WAITQ_H_
+#define _WAITQ_H_
+
+#include "defines.h"
+#include "list.h"
+
+// Threads blocked in the kernel wait on an object, identified by its 
+// address. Waiters are hashed by object into buckets, each kept in 
+// priority order, so blocking and waking on one object does not depend on
+// how many threads wait on others.
+#define WAITQ_BITS 8
+#define WAITQ_BUCKETS (1 << WAITQ_BITS)
+
+// The inlist of every thread blocked on a wait object; never holds TDs 
+// itself.
+extern LL* WaitQ;
+
+void InitWaitq(void);
+T_RC WaitOn(void *obj);
+T_RC WaitOnAny(void **objs, int n, uval32 *ready, Timer *timeout);
+void WaitqBlock(TD *td, void *obj);
+TD *WaitqDequeue(void *obj);
+bool Waited(void *obj);
+int Waiters(void *obj);
+TD *WakeOne(void *obj);
+int WakeN(void *obj, int n);
+void *UserKey(uvalptr addr);
+T_RC WaitSys(uvalptr addr);
+T_RC WakeSys(uvalptr addr, int n, int *woken);
+bool WaitingOn(TD *td, void *obj);
+void WaitqRemove(TD *td);
+void WaitqRequeue(TD *td);
+
+#endif
@@ -0,0 +1,65 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "waitset.h"
+#include "waitq.h"
+#include "timer.h"
+#include "sync.h"
+
+// Looks up item, returning the object to wait on or null if there is no
+// such item. With ready, also takes what is available of it.
+static void *Waitable(WaitItem *item, bool *ready)
+{
+  switch (item->type) {
+  case WAIT_ADDR:
+    return UserKey(item->id);
+  case WAIT_TIMER:
+    return TimerWaitable(item->id, ready);
+  case WAIT_SEM:
+    return SemWaitable(item->id, ready);
+  case WAIT_LATCH:
+    return LatchWaitable(item->id, ready);
+  default:
+    return NULL;
+  }
+}
+
+// SYS_WAIT_ANY: reports every item that is ready already, or blocks 
+// until the first one is. Returns FAILED for an unknown item, and 
+// RESOURCE_ERROR if there is no timer free for the timeout.
+T_RC WaitAny(WaitSet *set)
+{
+  void *objs[WAIT_MAX_OBJS];
+  Timer *timeout = NULL;
+  bool ready;
+  int i;
+
+  if ((set->count < 1) || (set->count > WAIT_MAX_OBJS)) {
+    return FAILED;
+  }
+
+  // Nothing is taken unless every item exists.
+  for (i = 0; i < set->count; i++) {
+    if ((objs[i] = Waitable(&set->items[i], NULL)) == NULL) {
+      return FAILED;
+    }
+  }
+
+  set->ready = 0;
+  for (i = 0; i < set->count; i++) {
+    ready = FALSE;
+    Waitable(&set->items[i], &ready);
+    if (ready) {
+      set->ready |= 1 << i;
+    }
+  }
+
+  if (set->ready || set->timeout == WAIT_POLL) {
+    return OK;
+  }
+
+  if (set->timeout > 0 && (timeout = TimeoutStart(set->timeout)) == NULL) {
+    return RESOURCE_ERROR;
+  }
+  return WaitOnAny(objs, set->count, &set->ready, timeout);
+}
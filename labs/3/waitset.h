@@ -0,0 +1,41 @@
+#ifndef _WAITSET_H_
+#define _WAITSET_H_
+
+#include "defines.h"
+#include "list.h"
+
+// Lets one thread serve several event sources: it blocks once on a set 
+// of objects and learns on wakeup which of them fired, instead of keeping
+// a thread per source or polling each with Yield().
+typedef enum { WAIT_ADDR, WAIT_TIMER, WAIT_SEM, WAIT_LATCH } WaitType;
+
+// Wait until the timeout, if > 0, in ticks; return at once if 0; or for
+// as long as it takes if < 0.
+#define WAIT_FOREVER (-1)
+#define WAIT_POLL 0
+
+typedef struct type_WAIT_ITEM WaitItem;
+typedef struct type_WAIT_SET WaitSet;
+
+struct type_WAIT_ITEM
+{
+  WaitType type;
+  // An address woken by SYS_WAKE, or a timer, semaphore or latch id.
+  uvalptr id;
+};
+
+// Passed to SYS_WAIT_ANY.
+struct type_WAIT_SET
+{
+  WaitItem items[WAIT_MAX_OBJS];
+  int count;
+  int timeout;
+  // Set by the kernel: bit i if items[i] fired, 0 if none did before the
+  // timeout. A semaphore reported here has been taken, and a timer's 
+  // expiry consumed, as by SYS_SEM_WAIT and SYS_TIMER_WAIT.
+  uval32 ready;
+};
+
+T_RC WaitAny(WaitSet *set);
+
+#endif
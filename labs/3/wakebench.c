@@ -0,0 +1,148 @@
+#include "defines.h"
+#include "list.h"
+#include "kernel.h"
+#include "user.h"
+#include "clock.h"
+#include "kinfo.h"
+#include "wakebench.h"
+
+#ifndef NATIVE
+
+#include <stdio.h>
+
+// Threads never run on x86, so each step below is taken by whichever 
+// thread the kernel made Active, as in WorkloadRun(). The releasing 
+// thread is the one prog started in; every other thread is a waiter.
+
+static ThreadId Waker;
+static ThreadId Tids[WAKEBENCH_MAX];
+static uval32 Parked;
+// How a waiter blocks when it runs: on Word, or suspended.
+static bool Suspending;
+static int Word;
+
+static double Ns(uval32 clocks, uval32 per)
+{
+  return 1e9 * clocks / CLOCK_HZ / per;
+}
+
+static void Park(void)
+{
+  if (Suspending) {
+    SysCall(SYS_SUSP, 0, 0, 0);
+  } else {
+    SysCall(SYS_WAIT, (uvalptr) &Word, 0, 0);
+  }
+}
+
+// Lets every waiter that is ready run and park again, until the waker 
+// is back. Returns when the last of them started running and counts 
+// each dispatch in *switches.
+static uval32 RunWaiters(uval32 *switches)
+{
+  uval32 last = ReadClock();
+
+  while (GetTid() != Waker) {
+    last = ReadClock();
+    (*switches)++;
+    Park();
+  }
+  (*switches)++;
+  return last;
+}
+
+static void Spawn(uval32 n)
+{
+  uval32 i;
+
+  Parked = 0;
+  Suspending = TRUE;
+  for (i = 0; i < n; i++) {
+    SysCall(SYS_CREATE, (uvalptr) WakeBench, STACKSIZE, WAKEBENCH_PRIORITY);
+  }
+  while (GetTid() != Waker) {
+    Tids[Parked++] = GetTid();
+    Park();
+  }
+}
+
+static void Reap(uval32 n)
+{
+  uval32 i;
+
+  for (i = 0; i < n; i++) {
+    SysCall(SYS_DIST, Tids[i], 0, 0);
+  }
+}
+
+// All n waiters blocked on Word, released by one SYS_WAKE. Released 
+// waiters suspend themselves, as in ResumeEach(), so that only the 
+// release differs; moving them back onto Word is not timed.
+static uval32 WakeAll(uval32 n, uval32 rounds, uval32 *switches)
+{
+  uval32 start, spent = 0;
+  uval32 r, i, untimed;
+  int woken;
+
+  for (r = 0; r < rounds; r++) {
+    Suspending = FALSE;
+    for (i = 0; i < n; i++) {
+      SysCall(SYS_RESUME, Tids[i], 0, 0);
+      RunWaiters(&untimed);
+    }
+    Suspending = TRUE;
+
+    start = ReadClock();
+    SysCall(SYS_WAKE, (uvalptr) &Word, 0, (uvalptr) &woken);
+    spent += RunWaiters(switches) - start;
+  }
+  return spent;
+}
+
+// All n waiters suspended, released by a SYS_RESUME each. Every resume
+// hands the CPU to the waiter before the next one can be issued.
+static uval32 ResumeEach(uval32 n, uval32 rounds, uval32 *switches)
+{
+  uval32 start, last, spent = 0;
+  uval32 r, i;
+
+  for (r = 0; r < rounds; r++) {
+    start = last = ReadClock();
+    for (i = 0; i < n; i++) {
+      SysCall(SYS_RESUME, Tids[i], 0, 0);
+      last = RunWaiters(switches);
+    }
+    spent += last - start;
+  }
+  return spent;
+}
+
+int WakeBench(uval32 rounds)
+{
+  uval32 wake, resume, wakeSwitches, resumeSwitches;
+  uval32 n;
+
+  if (rounds == 0) {
+    rounds = 100;
+  }
+
+  Waker = GetTid();
+  SysCall(SYS_CHANGE_PRI, Waker, WAKEBENCH_WAKER_PRIORITY, 0);
+
+  printf("waiters  wake-all ns  resume-each ns  wake-all switches  "
+	 "resume-each switches\n");
+  for (n = 1; n <= WAKEBENCH_MAX; n *= 2) {
+    wakeSwitches = resumeSwitches = 0;
+    Spawn(n);
+    wake = WakeAll(n, rounds, &wakeSwitches);
+    resume = ResumeEach(n, rounds, &resumeSwitches);
+    Reap(n);
+
+    printf("%7u %12.0f %15.0f %18u %21u\n", n, Ns(wake, rounds), 
+	   Ns(resume, rounds), wakeSwitches / rounds, 
+	   resumeSwitches / rounds);
+  }
+  return 0;
+}
+
+#endif /* NATIVE */
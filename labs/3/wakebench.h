@@ -0,0 +1,21 @@
+#ifndef _WAKEBENCH_H_
+#define _WAKEBENCH_H_
+
+#include "defines.h"
+
+// Release latency benchmark, x86 build only. With KWAKEBENCH=<rounds> in
+// the environment prog parks 1 to WAKEBENCH_MAX threads and releases 
+// them <rounds> times, once with a single SYS_WAKE and once with a 
+// SYS_RESUME per thread, and prints how long it takes until the last 
+// waiter has run.
+#define WAKEBENCH_ENV "KWAKEBENCH"
+#define WAKEBENCH_MAX 256
+// Waiters run ahead of the releasing thread, so every wakeup matters.
+#define WAKEBENCH_PRIORITY 10
+#define WAKEBENCH_WAKER_PRIORITY 20
+
+#ifndef NATIVE
+int WakeBench(uval32 rounds);
+#endif /* NATIVE */
+
+#endif
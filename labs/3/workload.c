@@ -0,0 +1,367 @@
+#include "defines.h"
+#include "list.h"
+#include "user.h"
+#include "main.h"
+#include "clock.h"
+#include "kinfo.h"
+#include "workload.h"
+
+#ifndef NATIVE
+#include "kernel.h"
+#include "io.h"
+#endif /* NATIVE */
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum { WL_SETUP, WL_RUNNING, WL_DONE } WorkloadPhase;
+
+typedef struct type_WORKER Worker;
+
+struct type_WORKER
+{
+  bool live;
+  uval32 rng;
+  // Position in Roster.
+  uval32 slot;
+};
+
+static WorkloadConfig Config;
+static WorkloadStats Stats;
+static WorkloadPhase Phase;
+static uval32 Start;
+
+static Worker Workers[NUM_TID + 1];
+// Tids of the live workers, for WL_RESUME.
+static ThreadId Roster[NUM_TID];
+static uval32 Live;
+
+static volatile uval32 Sink;
+
+typedef struct type_WORKLOAD_KEY WorkloadKey;
+
+struct type_WORKLOAD_KEY
+{
+  char *name;
+  uval32 *field;
+};
+
+// Fills config from a "key=value,..." list. Keys not mentioned keep 
+// their value.
+T_RC WorkloadParse(char *spec, WorkloadConfig *config)
+{
+  WorkloadKey keys[] = {
+    { "threads", &config->threads },
+    { "minpri", &config->minPriority },
+    { "maxpri", &config->maxPriority },
+    { "compute", &config->weight[WL_COMPUTE] },
+    { "yield", &config->weight[WL_YIELD] },
+    { "suspend", &config->weight[WL_SUSPEND] },
+    { "resume", &config->weight[WL_RESUME] },
+    { "churn", &config->churn },
+    { "ticks", &config->ticks },
+    { "work", &config->work },
+    { "seed", &config->seed },
+  };
+  char *value;
+  int len, i;
+
+  while (*spec) {
+    value = strchr(spec, '=');
+    if (!value) {
+      return FAILED;
+    }
+    len = value - spec;
+    for (i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+      if (strlen(keys[i].name) == len && !strncmp(keys[i].name, spec, len)) {
+	break;
+      }
+    }
+    if (i == sizeof(keys) / sizeof(keys[0])) {
+      return FAILED;
+    }
+    *keys[i].field = strtoul(value + 1, &spec, 0);
+    if (*spec == ',') {
+      spec++;
+    }
+  }
+  return OK;
+}
+
+// Creates the controller, which starts the workers. The controller runs 
+// at priority 1 while it creates them, then just below the workers, so it
+// only gets the processor when every worker is blocked.
+T_RC WorkloadStart(WorkloadConfig *config)
+{
+  if (config->minPriority < 2 || config->maxPriority >= MIN_PRIORITY - 1 ||
+      config->minPriority > config->maxPriority || 
+      config->threads > NUM_TID) {
+    return PRIORITY_ERROR;
+  }
+
+  Config = *config;
+  memset(&Stats, 0, sizeof(Stats));
+  Phase = WL_SETUP;
+  Live = 0;
+
+  return SysCall(SYS_CREATE, (uvalptr) WorkloadController, STACKSIZE, 1) > 
+    OK ? OK : FAILED;
+}
+
+static uval32 Random(Worker *w)
+{
+  w->rng = w->rng * 1103515245 + 12345;
+  return w->rng >> 16;
+}
+
+static void Join(ThreadId tid)
+{
+  Worker *w = &Workers[tid];
+
+  w->live = TRUE;
+  w->rng = Config.seed ^ (tid * 2654435761u);
+  w->slot = Live;
+  Roster[Live++] = tid;
+  if (Live > Stats.peak) {
+    Stats.peak = Live;
+  }
+}
+
+static void Leave(ThreadId tid)
+{
+  Worker *w = &Workers[tid];
+
+  w->live = FALSE;
+  Roster[w->slot] = Roster[--Live];
+  Workers[Roster[w->slot]].slot = w->slot;
+}
+
+static WorkloadOp Pick(Worker *w)
+{
+  uval32 sum = 0;
+  uval32 r;
+  int op;
+
+  if (Random(w) % 1000 < Config.churn) {
+    return WL_CHURN;
+  }
+
+  for (op = 0; op < WL_CHURN; op++) {
+    sum += Config.weight[op];
+  }
+  if (sum == 0) {
+    return WL_YIELD;
+  }
+
+  r = Random(w) % sum;
+  for (op = 0; r >= Config.weight[op]; op++) {
+    r -= Config.weight[op];
+  }
+  return op;
+}
+
+static void Spawn(void)
+{
+  if (SysCall(SYS_CREATE, (uvalptr) WorkloadWorker, STACKSIZE, 
+	      Config.minPriority + rand() % 
+	      (Config.maxPriority - Config.minPriority + 1)) < OK) {
+    Stats.createFailed++;
+  }
+}
+
+// One operation of the calling worker. Returns FALSE when the worker 
+// should destroy itself.
+bool WorkloadStep(void)
+{
+  ThreadId tid = GetTid();
+  Worker *w = &Workers[tid];
+  WorkloadOp op;
+  uval32 start, spent;
+  uval32 i;
+
+  if (!w->live) {
+    Join(tid);
+  }
+  if (Phase == WL_DONE || GetTicks() - Start >= Config.ticks) {
+    Leave(tid);
+    return FALSE;
+  }
+
+  op = Pick(w);
+  start = ReadClock();
+
+  switch (op) {
+  case WL_COMPUTE:
+    for (i = 0; i < Config.work; i++) {
+      Sink += i;
+    }
+    break;
+  case WL_YIELD:
+    SysCall(SYS_YIELD, 0, 0, 0);
+    break;
+  case WL_SUSPEND:
+    SysCall(SYS_SUSP, 0, 0, 0);
+    break;
+  case WL_RESUME:
+    SysCall(SYS_RESUME, Roster[Random(w) % Live], 0, 0);
+    break;
+  case WL_CHURN:
+    Spawn();
+    break;
+  default:
+    break;
+  }
+
+  spent = ReadClock() - start;
+  Stats.count[op]++;
+  Stats.total[op] += spent;
+  if (spent > Stats.max[op]) {
+    Stats.max[op] = spent;
+  }
+
+  if (op == WL_CHURN) {
+    Leave(tid);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static void Report(void)
+{
+  char *names[WL_OPS] = { "compute", "yield", "suspend", "resume", "churn" };
+  uval32 ops = 0;
+  int op;
+
+  myprint("workload: op count mean max\n");
+  for (op = 0; op < WL_OPS; op++) {
+    myprint(names[op]);
+    myprint(" ");
+    printHex(Stats.count[op]);
+    myprint(" ");
+    printHex(Stats.count[op] ? Stats.total[op] / Stats.count[op] : 0);
+    myprint(" ");
+    printHex(Stats.max[op]);
+    myprint("\n");
+    ops += Stats.count[op];
+  }
+  myprint("ops per second ");
+  printHex(ops * TICKS_PER_SECOND / (Config.ticks ? Config.ticks : 1));
+  myprint(" peak threads ");
+  printHex(Stats.peak);
+  myprint(" create failures ");
+  printHex(Stats.createFailed);
+  myprint("\n");
+
+  SysCall(SYS_LAT_DUMP, TRUE, 0, 0);
+  SysCall(SYS_KLOG_DUMP, TRUE, 0, 0);
+}
+
+// One round of the controller. Returns FALSE once the run is over and 
+// reported.
+bool WorkloadControlStep(void)
+{
+  uval32 i;
+
+  switch (Phase) {
+  case WL_SETUP:
+    srand(Config.seed);
+    Start = GetTicks();
+    Phase = WL_RUNNING;
+    for (i = 0; i < Config.threads; i++) {
+      Spawn();
+    }
+    SysCall(SYS_CHANGE_PRI, GetTid(), Config.maxPriority + 1, 0);
+    break;
+  case WL_RUNNING:
+    if (GetTicks() - Start >= Config.ticks) {
+      Phase = WL_DONE;
+    }
+    // Every worker is blocked: wake them all up.
+    for (i = 0; i < Live; i++) {
+      SysCall(SYS_RESUME, Roster[i], 0, 0);
+    }
+    break;
+  case WL_DONE:
+    if (Live == 0) {
+      Report();
+      return FALSE;
+    }
+    for (i = 0; i < Live; i++) {
+      SysCall(SYS_RESUME, Roster[i], 0, 0);
+    }
+    break;
+  }
+  SysCall(SYS_YIELD, 0, 0, 0);
+  return TRUE;
+}
+
+void WorkloadWorker(void)
+{
+  while (WorkloadStep());
+  SysCall(SYS_DIST, 0, 0, 0);
+}
+
+void WorkloadController(void)
+{
+  while (WorkloadControlStep());
+  SysCall(SYS_DIST, 0, 0, 0);
+}
+
+#ifndef NATIVE
+
+// One timer interrupt, as the processor would take it: with interrupts
+// off, and switching threads on the way out if the tick asked for it.
+void WorkloadTick(void)
+{
+  bool enabled;
+
+  TIMER_STATUS = TIMER_TO;
+  RaiseIrq(TIMER_IRQ);
+  enabled = IrqLock();
+  interrupt_handler(0);
+  IrqUnlock(enabled);
+  if (NeedResched) {
+    Preempt();
+  }
+}
+
+// Never runs on x86.
+void WorkloadNop(void)
+{
+}
+
+// Threads never run on x86, so play them here instead: whichever thread 
+// the kernel made Active takes its next step, and the timer interrupt is
+// raised in real time. Other threads would block on their devices, so 
+// they are suspended; the idle thread yields.
+void WorkloadRun(void)
+{
+  uval32 period = CLOCK_HZ / TICKS_PER_SECOND;
+  uval32 next = ReadClock() + period;
+  uval32 pc;
+
+  while (1) {
+    if ((int) (ReadClock() - next) >= 0) {
+      next += period;
+      WorkloadTick();
+    }
+
+    pc = Active->cold->regs.pc;
+    if (pc == (uval32) (uvalptr) WorkloadWorker) {
+      if (!WorkloadStep()) {
+	SysCall(SYS_DIST, 0, 0, 0);
+      }
+    } else if (pc == (uval32) (uvalptr) WorkloadController) {
+      if (!WorkloadControlStep()) {
+	SysCall(SYS_DIST, 0, 0, 0);
+	return;
+      }
+    } else if (Active->tid == IDLE_TID) {
+      SysCall(SYS_YIELD, 0, 0, 0);
+    } else {
+      SysCall(SYS_SUSP, 0, 0, 0);
+    }
+  }
+}
+
+#endif /* NATIVE */
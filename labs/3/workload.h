@@ -0,0 +1,60 @@
+#ifndef _WORKLOAD_H_
+#define _WORKLOAD_H_
+
+#include "defines.h"
+
+// Synthetic load for soak testing the kernel. A controller thread starts 
+// config.threads workers with priorities spread over 
+// [minPriority, maxPriority]. Until config.ticks have passed, each worker
+// repeatedly picks one operation with the given relative weights: spin 
+// for config.work iterations, yield, suspend itself, or resume a random 
+// worker. With probability churn/1000 per operation a worker instead 
+// starts a replacement and destroys itself. The controller then prints 
+// per-operation counts and costs and the wake-to-run histograms.
+typedef enum { WL_COMPUTE, WL_YIELD, WL_SUSPEND, WL_RESUME, WL_CHURN, \
+  WL_OPS } WorkloadOp;
+
+typedef struct type_WORKLOAD_CONFIG WorkloadConfig;
+typedef struct type_WORKLOAD_STATS WorkloadStats;
+
+struct type_WORKLOAD_CONFIG
+{
+  uval32 threads;
+  uval32 minPriority;
+  uval32 maxPriority;
+  uval32 weight[WL_CHURN];
+  uval32 churn;
+  uval32 ticks;
+  uval32 work;
+  uval32 seed;
+};
+
+// Cost of each operation in ReadClock() units.
+struct type_WORKLOAD_STATS
+{
+  uval32 count[WL_OPS];
+  uval32 total[WL_OPS];
+  uval32 max[WL_OPS];
+  uval32 createFailed;
+  uval32 peak;
+};
+
+// "threads=64,minpri=10,maxpri=40,compute=50,yield=30,suspend=10,
+// resume=10,churn=5,ticks=500,work=1000,seed=1"
+#define WORKLOAD_DEFAULT "threads=64,minpri=10,maxpri=40,compute=50,yield=30," \
+  "suspend=10,resume=10,churn=5,ticks=500,work=1000,seed=1"
+
+T_RC WorkloadParse(char *spec, WorkloadConfig *config);
+T_RC WorkloadStart(WorkloadConfig *config);
+bool WorkloadStep(void);
+bool WorkloadControlStep(void);
+void WorkloadWorker(void);
+void WorkloadController(void);
+void WorkloadRun(void);
+// For the x86 benchmarks and tests, which play threads themselves: one 
+// timer interrupt as the processor would take it, and a body for threads
+// that are only scheduled, never run.
+void WorkloadTick(void);
+void WorkloadNop(void);
+
+#endif